@@ -0,0 +1,172 @@
+// Minimal microbenchmark harness shared by the backend and viewer suites.
+//
+// Each case is calibrated so one repetition lasts at least --min-rep-ms, run
+// --warmup times untimed, then --reps times; the report gives the median and
+// p99 (nearest rank) of the per-repetition ns/op, plus min and mean. With
+// --json FILE the results are also written as JSON for scripts/bench_compare.py.
+//
+// Timings depend on the CPU frequency: a governor other than "performance",
+// turbo or a busy host shifts them. The governor is recorded in the JSON and
+// bench_compare refuses nothing but warns when the two runs differ.
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+struct Options {
+    int warmup = 3;
+    int reps = 30;
+    double minRepMs = 10.0;
+    std::string json;   // results file, empty: table only
+    std::string filter; // only cases whose name contains it
+};
+
+// Consumes argv[i] (and its value) if it is a harness option.
+inline bool parse_option(Options& opt, int& i, int argc, char** argv) {
+    std::string arg = argv[i];
+    if (arg == "--warmup" && i + 1 < argc) {
+        opt.warmup = std::max(0, std::atoi(argv[++i]));
+    } else if (arg == "--reps" && i + 1 < argc) {
+        opt.reps = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--min-rep-ms" && i + 1 < argc) {
+        opt.minRepMs = std::max(0.1, std::atof(argv[++i]));
+    } else if (arg == "--json" && i + 1 < argc) {
+        opt.json = argv[++i];
+    } else if (arg == "--filter" && i + 1 < argc) {
+        opt.filter = argv[++i];
+    } else {
+        return false;
+    }
+    return true;
+}
+
+constexpr const char* USAGE = "[--warmup N] [--reps N] [--min-rep-ms MS] [--json FILE] [--filter TEXT]";
+
+struct Result {
+    std::string name;
+    uint64_t items = 1;   // operations per call of the body
+    uint64_t calls = 1;   // body calls per repetition (calibrated)
+    int reps = 0;
+    double medianNs = 0.0; // per operation
+    double p99Ns = 0.0;
+    double minNs = 0.0;
+    double meanNs = 0.0;
+};
+
+inline std::string cpu_governor() {
+    std::ifstream f("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor");
+    std::string g;
+    if (!(f >> g)) g = "unknown";
+    return g;
+}
+
+// Keeps a value alive without the optimiser proving it unused.
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+class Suite {
+public:
+    Suite(std::string name, Options opt) : name_(std::move(name)), opt_(std::move(opt)) {
+        const std::string governor = cpu_governor();
+        std::printf("%s: warmup %d, %d reps of >= %.1f ms, governor %s\n", name_.c_str(), opt_.warmup, opt_.reps,
+                    opt_.minRepMs, governor.c_str());
+        if (governor != "performance") {
+            std::printf("  note: CPU frequency is not pinned (governor %s): compare runs from the same host and setup only\n",
+                        governor.c_str());
+        }
+        std::printf("%-40s %12s %12s %12s %12s\n", "case", "median ns", "p99 ns", "min ns", "mean ns");
+    }
+
+    // Times body(), which performs `items` operations per call.
+    template <typename Body>
+    void run(const std::string& name, uint64_t items, Body&& body) {
+        if (!opt_.filter.empty() && name.find(opt_.filter) == std::string::npos) return;
+        using Clock = std::chrono::steady_clock;
+        const double minRepNs = opt_.minRepMs * 1e6;
+        // calibrate: double the calls until one repetition is long enough
+        uint64_t calls = 1;
+        while (true) {
+            auto start = Clock::now();
+            for (uint64_t c = 0; c < calls; ++c) body();
+            double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            if (ns >= minRepNs || calls >= (1ull << 40)) break;
+            calls = ns > 0.0 ? std::max(calls * 2, static_cast<uint64_t>(calls * minRepNs / ns * 1.1)) : calls * 2;
+        }
+        for (int w = 0; w < opt_.warmup; ++w) {
+            for (uint64_t c = 0; c < calls; ++c) body();
+        }
+        std::vector<double> perOp(static_cast<size_t>(opt_.reps));
+        for (int r = 0; r < opt_.reps; ++r) {
+            auto start = Clock::now();
+            for (uint64_t c = 0; c < calls; ++c) body();
+            double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            perOp[r] = ns / static_cast<double>(calls * items);
+        }
+        std::sort(perOp.begin(), perOp.end());
+        Result res;
+        res.name = name;
+        res.items = items;
+        res.calls = calls;
+        res.reps = opt_.reps;
+        res.medianNs = perOp.size() % 2 ? perOp[perOp.size() / 2]
+                                        : 0.5 * (perOp[perOp.size() / 2 - 1] + perOp[perOp.size() / 2]);
+        res.p99Ns = perOp[std::min(perOp.size() - 1, static_cast<size_t>(std::ceil(0.99 * perOp.size())) - 1)];
+        res.minNs = perOp.front();
+        double sum = 0.0;
+        for (double v : perOp) sum += v;
+        res.meanNs = sum / static_cast<double>(perOp.size());
+        std::printf("%-40s %12.2f %12.2f %12.2f %12.2f\n", name.c_str(), res.medianNs, res.p99Ns, res.minNs, res.meanNs);
+        std::fflush(stdout);
+        results_.push_back(res);
+    }
+
+    // Writes the JSON file if one was asked for. Returns false if it could not be written.
+    bool finish() const {
+        if (opt_.json.empty()) return true;
+        std::FILE* f = std::fopen(opt_.json.c_str(), "w");
+        if (!f) {
+            std::perror(opt_.json.c_str());
+            return false;
+        }
+        char stamp[32];
+        std::time_t now = std::time(nullptr);
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+        std::fprintf(f, "{\n  \"suite\": \"%s\",\n  \"format\": 1,\n  \"timestamp\": \"%s\",\n", name_.c_str(), stamp);
+        std::fprintf(f, "  \"host\": {\"cpus\": %u, \"governor\": \"%s\", \"compiler\": \"%s\"},\n",
+                     std::thread::hardware_concurrency(), cpu_governor().c_str(), __VERSION__);
+        std::fprintf(f, "  \"config\": {\"warmup\": %d, \"reps\": %d, \"min_rep_ms\": %.3f},\n  \"unit\": \"ns/op\",\n",
+                     opt_.warmup, opt_.reps, opt_.minRepMs);
+        std::fprintf(f, "  \"results\": [\n");
+        for (size_t i = 0; i < results_.size(); ++i) {
+            const Result& r = results_[i];
+            std::fprintf(f,
+                         "    {\"name\": \"%s\", \"items\": %llu, \"calls\": %llu, \"reps\": %d, \"median\": %.4f, "
+                         "\"p99\": %.4f, \"min\": %.4f, \"mean\": %.4f}%s\n",
+                         r.name.c_str(), static_cast<unsigned long long>(r.items), static_cast<unsigned long long>(r.calls),
+                         r.reps, r.medianNs, r.p99Ns, r.minNs, r.meanNs, i + 1 < results_.size() ? "," : "");
+        }
+        std::fprintf(f, "  ]\n}\n");
+        std::fclose(f);
+        std::printf("results written to %s\n", opt_.json.c_str());
+        return true;
+    }
+
+private:
+    std::string name_;
+    Options opt_;
+    std::vector<Result> results_;
+};
+
+} // namespace bench
@@ -0,0 +1,157 @@
+// Hot paths of the table loop, timed with bench_harness.hpp: reel sampling
+// and payout (the spin), the alias draw of one symbol, the batch RNG, latency
+// recording, both rings and the engine's roll + commit, on private segments
+// laid out like a table's.
+//
+//   bench_hot [--warmup N] [--reps N] [--min-rep-ms MS] [--json FILE] [--filter TEXT]
+#include "bench_harness.hpp"
+#include "bet_ring.hpp"
+#include "event_ring.hpp"
+#include "ipc_shared.hpp"
+#include "latency_hist.hpp"
+#include "slot_math.hpp"
+#include "table_engine.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <sys/mman.h>
+#include <vector>
+
+namespace {
+
+// Anonymous mapping initialised like a server segment (rings, histograms).
+casino::SharedState* make_segment(const casino::SegmentConfig& cfg, size_t& size) {
+    casino::SegmentLayout layout{};
+    if (!casino::compute_layout(cfg, layout)) return nullptr;
+    size = layout.segmentSize;
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED) return nullptr;
+    auto* state = static_cast<casino::SharedState*>(addr);
+    if (!casino::initialize_state(state, cfg)) {
+        munmap(addr, size);
+        return nullptr;
+    }
+    return state;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Options opt;
+    for (int i = 1; i < argc; ++i) {
+        if (!bench::parse_option(opt, i, argc, argv)) {
+            std::fprintf(stderr, "Usage: bench_hot %s\n", bench::USAGE);
+            return 1;
+        }
+    }
+    bench::Suite suite("bench_hot", opt);
+
+    // the spin: stops of every reel, then the payout (what the table does per bet)
+    casino::ReelSampler sampler;
+    casino::reel_sampler_init(sampler, 42);
+    for (size_t batch : {size_t{1}, size_t{64}}) {
+        std::vector<uint8_t> stops(batch * casino::REEL_COUNT);
+        suite.run("spin/draw_stops+payout/batch" + std::to_string(batch), batch, [&]() {
+            casino::draw_stops(sampler, stops.data(), batch);
+            int32_t total = 0;
+            for (size_t s = 0; s < batch; ++s) total += casino::spin_payout(&stops[s * casino::REEL_COUNT]);
+            bench::keep(total);
+        });
+    }
+
+    // one symbol from pre-drawn randoms (the alias lookup alone)
+    casino::AliasTable alias;
+    casino::build_alias_table(casino::SYMBOL_WEIGHTS, casino::SYMBOL_COUNT, alias);
+    casino::BatchRng rng;
+    casino::BatchRng retry;
+    casino::batch_rng_seed(rng, 7);
+    casino::batch_rng_seed(retry, 8);
+    std::vector<uint64_t> randoms(1024);
+    casino::batch_rng_fill(rng, randoms.data(), randoms.size());
+    suite.run("spin/sample_alias", randoms.size(), [&]() {
+        uint32_t acc = 0;
+        for (uint64_t r : randoms) acc += casino::sample_alias(alias, retry, r);
+        bench::keep(acc);
+    });
+    suite.run("rng/batch_rng_fill/64", 64, [&]() {
+        uint64_t out[64];
+        casino::batch_rng_fill(rng, out, 64);
+        bench::keep(out[63]);
+    });
+
+    casino::SegmentConfig cfg;
+    size_t size = 0;
+    casino::SharedState* state = make_segment(cfg, size);
+    if (!state) {
+        std::fprintf(stderr, "bench_hot: cannot build a segment\n");
+        return 1;
+    }
+
+    casino::LatencyHistogram* block = casino::latency_block_of(state);
+    uint64_t ns = 1000;
+    suite.run("latency/record", 1, [&]() {
+        ns = ns * 6364136223846793005ull + 1442695040888963407ull; // spread over the buckets
+        casino::latency_record(block[0], (ns >> 40) + 1);
+    });
+
+    // bet ring: one full frame in, drained back out (producer and consumer on one thread)
+    casino::BetRing* bets = casino::bet_ring_of(state);
+    casino::BetFrame frame{};
+    frame.count = casino::BET_FRAME_MAX;
+    for (int b = 0; b < casino::BET_FRAME_MAX; ++b) frame.bets[b] = casino::BetEntry{b, 50, 1};
+    suite.run("bet_ring/push+drain", 1, [&]() {
+        casino::BetFrame out[4];
+        casino::bet_ring_push(bets, frame);
+        bench::keep(casino::bet_ring_drain(bets, out, 4));
+    });
+
+    // event ring: a commit's publish, and a reader catching up on 64 events
+    casino::EventRing* events = casino::event_ring_of(state);
+    casino::SpinEvent ev{};
+    suite.run("event_ring/publish", 1, [&]() {
+        ev.tick++;
+        casino::event_ring_publish(events, ev);
+    });
+    suite.run("event_ring/publish64+read64", 64, [&]() {
+        casino::EventCursor cursor = casino::event_cursor_at_head(events);
+        for (int e = 0; e < 64; ++e) {
+            ev.tick++;
+            casino::event_ring_publish(events, ev);
+        }
+        casino::SpinEvent out[64];
+        bench::keep(casino::event_ring_read(events, cursor, out, 64));
+    });
+
+    munmap(state, size);
+
+    // the table loop's iteration: N bets rolled, then committed in one critical
+    // section (seats, counters, N events). The clock jumps past every cooldown
+    // between iterations so each bet spins.
+    for (int spins : {1, 64, 256}) {
+        casino::SegmentConfig tableCfg;
+        tableCfg.capacity = static_cast<uint32_t>(spins);
+        size_t tableSize = 0;
+        casino::SharedState* table = make_segment(tableCfg, tableSize);
+        if (!table) {
+            std::fprintf(stderr, "bench_hot: cannot build a %d-seat segment\n", spins);
+            return 1;
+        }
+        casino::EngineConfig engineCfg;
+        engineCfg.randomStarts = false;
+        casino::TableEngine engine;
+        engine.wakeReaders = false;
+        auto now = std::chrono::steady_clock::time_point{};
+        engine.init(table, engineCfg, 0, spins, now);
+        std::vector<casino::BetMessage> round;
+        for (int p = 0; p < spins; ++p) round.push_back(casino::BetMessage{p, 50, 0, 1, 0, 0, 0});
+        suite.run("engine/roll+commit/spins" + std::to_string(spins), static_cast<size_t>(spins), [&]() {
+            now += std::chrono::seconds(10);
+            engine.roll(now, round, false);
+            engine.commit(now, casino::TickSample{}, &round);
+        });
+        munmap(table, tableSize);
+    }
+
+    return suite.finish() ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+// Per-tick player update: legacy AoS records vs SoA hot arrays, as the server
+// ran it before animations were published as timestamps. Optionally runs a
+// thread that keeps rewriting pids, the way player processes do, to expose
+// false sharing with the tick loop.
+//
+//   bench_players [--ticks N] [--pid-writer]
+#include "player_tick.hpp"
+#include "protocol.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// The pre-SoA shared layout: hot, cold and player-written fields interleaved.
+struct LegacyPlayer {
+    int32_t id = -1;
+    float x = 0.0f;
+    float y = 0.0f;
+    int32_t animState = 0;
+    float pulse = 0.0f;
+    int32_t symbols[3] = {0, 1, 2};
+    int32_t lastDelta = 0;
+    int32_t spinning = 0;
+    float spinProgress = 0.0f;
+    int32_t lastPayout = 0;
+    int32_t pid = -1;
+};
+
+bool legacy_tick(std::vector<LegacyPlayer>& players, float dProgress, float dPulse) {
+    bool animating = false;
+    for (auto& p : players) {
+        if (p.spinning) {
+            p.spinProgress += dProgress;
+            if (p.spinProgress >= 1.0f) {
+                p.spinning = 0;
+                p.spinProgress = 1.0f;
+            }
+        }
+        p.pulse = std::max(0.0f, p.pulse - dPulse);
+        animating = animating || p.spinning || p.pulse > 0.0f;
+    }
+    return animating;
+}
+
+// Restarts every 4th seat so the loop always has live spins and pulses.
+template <typename Restart, typename Tick>
+double run(int ticks, int n, Restart restart, Tick tick) {
+    auto start = std::chrono::steady_clock::now();
+    volatile bool sink = false;
+    for (int t = 0; t < ticks; ++t) {
+        if (t % 32 == 0) restart(t / 32);
+        sink = tick();
+    }
+    (void)sink;
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return ns / (static_cast<double>(ticks) * n);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int ticks = 20000;
+    bool pidWriter = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--ticks" && i + 1 < argc) {
+            ticks = std::max(32, std::atoi(argv[++i]));
+        } else if (arg == "--pid-writer") {
+            pidWriter = true;
+        }
+    }
+    const float dProgress = 1.0f / 120.0f; // 2 s spin at 60 Hz
+    const float dPulse = 0.6f / 60.0f;
+
+    std::printf("%-8s %-8s %14s %14s %8s\n", "players", "ticks", "aos ns/seat", "soa ns/seat", "speedup");
+    for (int n : {16, 1024, 65536}) {
+        // same seat-update budget for every size (ticks x 1024 seats)
+        int runTicks = static_cast<int>(std::clamp<long long>(static_cast<long long>(ticks) * 1024 / n, 32, ticks));
+
+        std::vector<LegacyPlayer> aos(n);
+        std::atomic<bool> stop{false};
+        std::thread writer;
+        if (pidWriter) {
+            writer = std::thread([&]() {
+                for (int k = 0; !stop.load(std::memory_order_relaxed); ++k) {
+                    reinterpret_cast<volatile int32_t&>(aos[k % n].pid) = k;
+                }
+            });
+        }
+        double aosNs = run(runTicks, n,
+            [&](int round) {
+                for (int i = round % 4; i < n; i += 4) {
+                    aos[i].spinning = 1;
+                    aos[i].spinProgress = 0.0f;
+                    aos[i].pulse = 1.0f;
+                }
+            },
+            [&]() { return legacy_tick(aos, dProgress, dPulse); });
+        stop.store(true);
+        if (writer.joinable()) writer.join();
+
+        // SoA arrays, each on its own cache lines like in the segment
+        auto alloc = [n](size_t elem) {
+            size_t bytes = (static_cast<size_t>(n) * elem + 63) / 64 * 64;
+            void* p = std::aligned_alloc(64, bytes);
+            std::memset(p, 0, bytes);
+            return p;
+        };
+        float* progress = static_cast<float*>(alloc(sizeof(float)));
+        float* pulse = static_cast<float*>(alloc(sizeof(float)));
+        int32_t* spinning = static_cast<int32_t*>(alloc(sizeof(int32_t)));
+        int32_t* pids = static_cast<int32_t*>(alloc(sizeof(int32_t)));
+        stop.store(false);
+        if (pidWriter) {
+            writer = std::thread([&]() {
+                for (int k = 0; !stop.load(std::memory_order_relaxed); ++k) {
+                    reinterpret_cast<volatile int32_t&>(pids[k % n]) = k;
+                }
+            });
+        }
+        double soaNs = run(runTicks, n,
+            [&](int round) {
+                for (int i = round % 4; i < n; i += 4) {
+                    spinning[i] = 1;
+                    progress[i] = 0.0f;
+                    pulse[i] = 1.0f;
+                }
+            },
+            [&]() { return casino::advance_players(progress, pulse, spinning, n, dProgress, dPulse); });
+        stop.store(true);
+        if (writer.joinable()) writer.join();
+        std::free(progress);
+        std::free(pulse);
+        std::free(spinning);
+        std::free(pids);
+
+        std::printf("%-8d %-8d %14.3f %14.3f %7.2fx\n", n, runTicks, aosNs, soaNs, aosNs / soaNs);
+    }
+    return 0;
+}
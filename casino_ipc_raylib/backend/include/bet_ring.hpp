@@ -0,0 +1,52 @@
+#pragma once
+
+#include "protocol.hpp"
+#include <atomic>
+#include <cstddef>
+
+namespace casino {
+
+inline BetRing* bet_ring_of(SharedState* state) {
+    return reinterpret_cast<BetRing*>(reinterpret_cast<char*>(state) + state->header.betRingOffset);
+}
+
+inline const BetRing* bet_ring_of(const SharedState* state) {
+    return reinterpret_cast<const BetRing*>(reinterpret_cast<const char*>(state) + state->header.betRingOffset);
+}
+
+// Owner only: constructs the ring header and its `slots` entries in place.
+void bet_ring_init(BetRing* ring, uint32_t slots);
+
+// Producer side (any process, any thread). Publishes without a syscall; issues a
+// futex wake only when the server is parked. Returns false (and counts an
+// overflow) if the ring is full, or if the push stalled past BET_SLOT_ABANDON_NS
+// between claiming its ticket and claiming the slot for writing, and the server
+// skipped the ticket meanwhile (the slot is left untouched).
+bool bet_ring_push(BetRing* ring, const BetFrame& frame);
+
+// Consumer side (server only). Moves up to `max` published frames into `out`
+// in one pass and returns how many were taken. A ticket claimed but not written
+// for BET_SLOT_ABANDON_NS, or being written by a producer that died, is skipped,
+// counted in `abandoned`, and its slot handed back to producers.
+size_t bet_ring_drain(BetRing* ring, BetFrame* out, size_t max);
+
+// Consumer side: parks on the futex until a producer publishes or timeoutMs
+// elapses (timeoutMs < 0: no timeout). Returns immediately if bets are pending,
+// and no later than the abandon deadline of a stalled ticket. With `stop`, also
+// returns without sleeping once *stop is set: set it, then bet_ring_kick, and
+// the consumer cannot miss the wakeup.
+void bet_ring_wait(BetRing* ring, int timeoutMs, const std::atomic<bool>* stop = nullptr);
+
+// Consumer side: true if the next frame is published, or if a stalled ticket is
+// due to be skipped. No syscall, no store: cheap enough to busy-poll
+// (casino_server --realtime).
+bool bet_ring_pending(const BetRing* ring);
+
+// Wakes a consumer parked in bet_ring_wait unconditionally (shutdown path,
+// after setting the consumer's stop flag).
+void bet_ring_kick(BetRing* ring);
+
+// Frames published but not yet drained (approximate while producers are active).
+uint64_t bet_ring_depth(const BetRing* ring);
+
+} // namespace casino
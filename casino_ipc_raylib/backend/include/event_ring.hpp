@@ -0,0 +1,37 @@
+#pragma once
+
+#include "protocol.hpp"
+#include <cstddef>
+
+namespace casino {
+
+inline EventRing* event_ring_of(SharedState* state) {
+    return reinterpret_cast<EventRing*>(reinterpret_cast<char*>(state) + state->header.eventRingOffset);
+}
+
+inline const EventRing* event_ring_of(const SharedState* state) {
+    return reinterpret_cast<const EventRing*>(reinterpret_cast<const char*>(state) + state->header.eventRingOffset);
+}
+
+// Owner only: constructs the ring header and its `slots` entries in place.
+void event_ring_init(EventRing* ring, uint32_t slots);
+
+// Writer side (the table's server thread only). Overwrites the oldest slot,
+// never blocks and takes no lock.
+void event_ring_publish(EventRing* ring, const SpinEvent& ev);
+
+// Reader-local position in the event stream; each viewer/tool owns one.
+struct EventCursor {
+    uint64_t next = 0; // number of the next event to read
+    uint64_t lost = 0; // events overwritten before this reader got to them
+};
+
+// Cursor positioned after the last published event: the reader only sees
+// events published from now on.
+EventCursor event_cursor_at_head(const EventRing* ring);
+
+// Copies up to `max` events newer than the cursor into `out` and advances it.
+// Events the writer lapped meanwhile are skipped and added to cursor.lost.
+size_t event_ring_read(const EventRing* ring, EventCursor& cursor, SpinEvent* out, size_t max);
+
+} // namespace casino
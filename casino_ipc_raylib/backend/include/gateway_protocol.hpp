@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+
+namespace casino {
+
+// Wire protocol of casino_gateway: a stream of messages, each a GatewayHeader
+// followed by `count` fixed-size records of its type. Little-endian, no
+// padding; every message fits in a connection's input buffer.
+constexpr uint8_t GATEWAY_PROTOCOL_VERSION = 1;
+constexpr int GATEWAY_BETS_MAX = 32;    // bets per GW_BETS message
+constexpr int GATEWAY_RESULTS_MAX = 64; // results per GW_RESULT message
+
+enum GatewayType : uint8_t {
+    GW_BETS = 1,   // client -> gateway: `count` GatewayBet
+    GW_ACK = 2,    // gateway -> client: one GatewayAck, count = 1
+    GW_RESULT = 3, // gateway -> client: `count` GatewayResult
+    GW_ERROR = 4,  // gateway -> client: count = GatewayError, then the gateway closes
+};
+
+enum GatewayError : uint16_t {
+    GW_ERR_VERSION = 1, // unknown protocol version
+    GW_ERR_TYPE = 2,    // a client sent something other than GW_BETS
+    GW_ERR_COUNT = 3,   // count of 0 or above GATEWAY_BETS_MAX
+};
+
+struct GatewayHeader {
+    uint8_t version = GATEWAY_PROTOCOL_VERSION;
+    uint8_t type = 0;
+    uint16_t count = 0;
+};
+
+struct GatewayBet {
+    int32_t playerId = -1; // global player id: table id % T, seat id / T (as `player`)
+    int32_t amount = 0;
+    int32_t spins = 1;     // BetEntry::spins
+};
+
+// Bets of the client's GW_BETS messages since the previous ack: handed to the
+// server, or refused (unknown player, bet channel full). Sent once per loop of
+// the gateway that read bets from the connection.
+struct GatewayAck {
+    uint32_t forwarded = 0;
+    uint32_t refused = 0;
+};
+
+// A spin of a player this connection bet for last (SpinEvent of its table).
+struct GatewayResult {
+    int32_t playerId = -1; // global player id
+    int32_t delta = 0;
+    int32_t payout = 0;
+    int32_t symbols[3] = {0, 0, 0};
+    uint32_t table = 0;
+    uint32_t reserved = 0;
+    uint64_t tick = 0;
+};
+
+static_assert(sizeof(GatewayHeader) == 4 && sizeof(GatewayBet) == 12 && sizeof(GatewayAck) == 8 &&
+                  sizeof(GatewayResult) == 40,
+              "gateway records are wire formats");
+
+} // namespace casino
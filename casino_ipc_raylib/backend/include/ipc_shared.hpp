@@ -1,28 +1,150 @@
 #pragma once
 
 #include "protocol.hpp"
+#include <atomic>
+#include <cerrno>
+#include <mqueue.h>
 #include <optional>
+#include <sched.h>
 #include <string>
+#include <sys/types.h>
+#include <time.h>
+#include <vector>
 
 namespace casino {
 
 struct SharedHandle {
     int fd = -1;
     SharedState* state = nullptr;
+    size_t size = 0; // mapped bytes (header.segmentSize)
     bool owner = false;
+    bool fileBacked = false; // mapped from the CASINO_STATE_FILE file
+    bool adopted = false;    // owner found a valid state file: call adopt_state, not initialize_state
+    int lockFd = -1;         // owner of a file-backed table: flock on "<file>.lock", held until close
 };
 
-// Create or open shared memory; owner=true creates/initialises with mutex attributes.
-std::optional<SharedHandle> open_shared_memory(bool owner);
+// Byte offsets of every region for a given config.
+struct SegmentLayout {
+    uint64_t playersOffset = 0;
+    uint64_t spinStartOffset = 0;
+    uint64_t pulseStartOffset = 0;
+    uint64_t pulsePeakOffset = 0;
+    uint64_t pidOffset = 0;
+    uint64_t seatGenOffset = 0;
+    uint64_t groupGenOffset = 0;
+    uint64_t betRingOffset = 0;
+    uint64_t eventRingOffset = 0;
+    uint64_t latencyOffset = 0;
+    uint64_t lockProfileOffset = 0;
+    uint64_t segmentSize = 0;
+};
+
+// Computes the layout; false if the config is invalid (ring sizes not a power
+// of two) or the segment would overflow size_t.
+bool compute_layout(const SegmentConfig& cfg, SegmentLayout& out);
+
+// IPC object names of one table: table 0 keeps SHM_NAME/MQ_NAME, table t > 0
+// appends ".t<t>" so several tables coexist on one host.
+std::string table_shm_name(int table);
+std::string table_mq_name(int table);
+
+// Backing object of a table segment: the file named by CASINO_STATE_FILE
+// (".t<t>" for t > 0) when that variable is set, else the POSIX shm object.
+// state_file_path() is empty when segments are not file-backed.
+std::string state_file_path(int table);
+int open_segment_fd(int table, int flags, mode_t mode);
+void unlink_segment(int table);
+
+// Player id -> (table, seat): ids are dealt round-robin across tables.
+inline int table_of_player(int id, int tableCount) { return id % tableCount; }
+inline int seat_of_player(int id, int tableCount) { return id / tableCount; }
+
+// Create or open the shared memory of `table`. owner=true creates a fresh
+// segment sized for `cfg` (call initialize_state next), unless a file-backed
+// segment already holds a valid state laid out for `cfg`: it is then mapped
+// as is with handle.adopted set (call adopt_state). A file-backed owner first
+// locks the file for its lifetime and fails if another server holds it.
+// Otherwise the existing segment is mapped whole and its header validated.
+std::optional<SharedHandle> open_shared_memory(bool owner, const SegmentConfig& cfg = {}, int table = 0);
+
+// Observers that never write nor lock (exporter): maps the segment of `table`
+// O_RDONLY / PROT_READ and validates its header. Writing through
+// handle.state faults.
+std::optional<SharedHandle> open_shared_memory_readonly(int table = 0);
+
+// True if the mapped segment carries our magic/ABI, a matching header checksum
+// and fits in mappedSize bytes.
+bool validate_header(const SharedState* state, size_t mappedSize);
 
-// Closes fd + unmaps (does not unlink).
+// FNV-1a of the layout fields of the header (not magic, epoch, clean flag,
+// transport or profiling switch, which change while the layout does not).
+uint64_t header_checksum(const SegmentHeader& h);
+
+// Closes fd + unmaps (does not unlink); releases the owner's state file lock.
 void close_shared_memory(SharedHandle& handle);
 
-// Unlink SHM and MQ names.
-void unlink_ipc();
+// Unlink the SHM and MQ names of `table`.
+void unlink_ipc(int table = 0);
+
+// Initialize header, mutex/process-shared, bet and event rings, latency
+// histograms, lock profile and zero state for `cfg`.
+// Only call once (owner path); the magic is published last.
+bool initialize_state(SharedState* state, const SegmentConfig& cfg);
+
+// Owner of an adopted segment: fresh mutex, settings of `cfg` that may change
+// between runs, dirty flag and a new epoch. Game state, rings and histograms
+// are kept.
+bool adopt_state(SharedState* state, const SegmentConfig& cfg);
+
+// File-backed segments: msync the mapping (blocking with `wait`); no-op otherwise.
+bool sync_segment(const SharedHandle& handle, bool wait);
+
+// Real-time mappings (casino_server --realtime, viewers with CASINO_REALTIME):
+// asks for transparent huge pages, prefaults the whole range (MADV_POPULATE_*,
+// or a MAP_POPULATE remap of `fd` on kernels without it) and mlocks it, so the
+// hot path never takes a page fault. Best effort: logs and returns false on
+// the first step that fails (typically RLIMIT_MEMLOCK).
+bool prefault_mapping(void* addr, size_t size, int fd, bool writable);
+
+// Client end of the server's bet channel: the shared ring, or the MQ fallback
+// when the segment advertises BET_TRANSPORT_MQ (or no segment is mapped).
+struct BetSender {
+    BetTransport transport = BET_TRANSPORT_MQ;
+    BetRing* ring = nullptr;
+    mqd_t mq = static_cast<mqd_t>(-1);
+    uint32_t version = BET_PROTOCOL_VERSION; // negotiated from the header
+    uint32_t id = 0;                         // BetFrame::sender
+    uint32_t seq = 0;                        // last frame published
+};
+
+// `state` may be null: the sender then falls back to the message queue of
+// `table` and assumes BET_PROTOCOL_VERSION. Fails if the header advertises no
+// protocol version this build speaks. senderId 0: the pid (threads sharing a
+// process need their own ids to keep separate sequences).
+std::optional<BetSender> open_bet_sender(SharedState* state, int table = 0, uint32_t senderId = 0);
 
-// Initialize mutex/process-shared and zero state. Only call once (owner path).
-bool initialize_state(SharedState* state);
+// Packs `bets` into frames of up to BET_FRAME_MAX, each stamped with the next
+// sequence number and monotonic_ns(). Ring: lock-free publish. MQ: mq_send (the
+// server polls the queue descriptor). Returns the bets sent: stops at the first
+// frame the channel refuses (ring or queue full).
+size_t send_bets(BetSender& sender, const BetEntry* bets, size_t count);
+bool send_bet(BetSender& sender, const BetEntry& bet);
+
+void close_bet_sender(BetSender& sender);
+
+// Thin wrappers over the futex syscall on shared (non-private) mappings.
+// futex_wait returns when woken, on timeout (timeoutMs < 0: none) or if
+// *word != expected on entry.
+void futex_wait(const std::atomic<uint32_t>* word, uint32_t expected, int timeoutMs);
+void futex_wake(std::atomic<uint32_t>* word, int count);
+
+// CLOCK_MONOTONIC in ns: the clock of BetFrame::sentNs, SpinEvent timestamps
+// and the server's steady_clock.
+inline uint64_t monotonic_ns() {
+    struct timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
 
 // Lock helper that handles owner-dead robust mutexes.
 inline bool safe_mutex_lock(pthread_mutex_t* m) {
@@ -38,4 +160,65 @@ inline bool safe_mutex_lock(pthread_mutex_t* m) {
     return false;
 }
 
+// Seqlock write section. Call with state->mutex held; every store to the shared
+// state must happen between publish_begin() and publish_end().
+// If a previous writer died mid-section (robust mutex recovered), seq is already
+// odd: we move it to the next odd value so in-flight readers still retry.
+inline uint32_t publish_begin(SharedState* state) {
+    uint32_t v = state->seq.load(std::memory_order_relaxed);
+    uint32_t odd = (v + 1) | 1u;
+    state->seq.store(odd, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return odd;
+}
+
+inline void publish_end(SharedState* state, uint32_t begin) {
+    state->generation.store(state->generation.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    state->seq.store(begin + 1, std::memory_order_release);
+}
+
+// Change tracking. Every publish_end() bumps `generation`. Inside a write
+// section the writer stamps each seat it modifies with the generation being
+// published, so a reader that copied generation g only needs the seats
+// stamped after g (collect_changed_seats). After unlocking, the writer wakes
+// the readers parked in wait_state_change().
+inline void mark_seat_changed(SharedState* state, const PlayerArrays& players, uint32_t seat) {
+    const uint32_t next = state->generation.load(std::memory_order_relaxed) + 1;
+    players.seatGen[seat] = next;
+    players.groupGen[seat / SEAT_GROUP] = next;
+}
+
+// One FUTEX_WAKE for every parked reader (readers map the segment read-only
+// and cannot announce themselves, so the wake is unconditional).
+void notify_state_change(SharedState* state);
+
+// Sleeps until the generation differs from `seen` or timeoutMs elapses
+// (< 0: no timeout). Returns the generation then current.
+uint32_t wait_state_change(const SharedState* state, uint32_t seen, int timeoutMs);
+
+// Appends to `out`, ascending, the seats below `count` stamped after
+// generation `since`; reads only the groups that changed. Call inside
+// read_consistent(). False if `since` is too far behind for the 32-bit stamps
+// to be compared: the caller then copies every seat.
+bool collect_changed_seats(const SharedState* state, const ConstPlayerArrays& players, uint32_t since, int count,
+                           std::vector<uint32_t>& out);
+
+// Lock-free reader side of the seqlock. `copy` is invoked until it observes a
+// stable even sequence; returns the number of retries, or -1 after maxRetries.
+// After a few busy retries the reader yields so a descheduled writer can finish.
+template <typename CopyFn>
+inline int read_consistent(const SharedState* state, CopyFn&& copy, int maxRetries = 1000) {
+    constexpr int spinRetries = 16;
+    for (int attempt = 0; attempt <= maxRetries; ++attempt) {
+        if (attempt > spinRetries) sched_yield();
+        uint32_t before = state->seq.load(std::memory_order_acquire);
+        if (before & 1u) continue;
+        copy();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint32_t after = state->seq.load(std::memory_order_relaxed);
+        if (before == after) return attempt;
+    }
+    return -1;
+}
+
 } // namespace casino
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace casino {
+
+// Append-only binary journal of one table, memory-mapped and grown in chunks.
+// Layout: JournalHeader, then fixed-size JournalRecords. Timestamps are
+// monotonic nanoseconds since the table started. One writer per file.
+constexpr uint32_t JOURNAL_MAGIC = 0x4E524A43; // "CJRN"
+constexpr uint32_t JOURNAL_VERSION = 5; // 2: pending bet slots (betTtlMs), 3: autoplay (BET b), 4: no animation tick (spin stamps in the digest), 5: lastWinnerId is the global player id
+
+enum JournalType : uint32_t {
+    JOURNAL_LOOP = 1,   // loop iteration: a = timer fired, b = BET records that follow
+    JOURNAL_BET = 2,    // bet arrival: seat, a = amount, b = spins (BetEntry::spins)
+    JOURNAL_SPIN = 3,   // spin outcome: seat, a = symbols (s0 | s1 << 8 | s2 << 16), b = payout, c = 1 if random start
+    JOURNAL_COMMIT = 4, // state published: a = tick (low 32 bits), c = state digest
+};
+
+struct JournalRecord {
+    uint64_t t = 0; // ns since table start (steady clock)
+    uint32_t type = 0;
+    int32_t seat = -1;
+    int32_t a = 0;
+    int32_t b = 0;
+    uint64_t c = 0;
+};
+static_assert(sizeof(JournalRecord) == 32, "journal records are fixed 32-byte entries");
+
+// Everything the table logic needs to re-execute from the records.
+struct JournalHeader {
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint64_t seed = 0;
+    int32_t tableId = 0;
+    int32_t tableCount = 1;
+    int32_t seats = 0;
+    int32_t randomStarts = 1;
+    std::atomic<uint64_t> records{0}; // published after each append
+    int32_t betTtlMs = 0;             // lifetime of a bet held through a cooldown (0: unlimited)
+    int32_t reserved0 = 0;
+    uint64_t reserved[2] = {};
+};
+static_assert(sizeof(JournalHeader) == 64, "journal header is one cache line");
+
+struct JournalWriter {
+    int fd = -1;
+    JournalHeader* header = nullptr; // start of the mapping
+    size_t mapped = 0;               // bytes mapped (file size while open)
+    uint64_t records = 0;
+};
+
+// Creates (truncates) `path` and writes `meta` as its header.
+bool journal_create(JournalWriter& w, const std::string& path, const JournalHeader& meta);
+
+// Appends one record; grows the file by a chunk when full. False on I/O error
+// (the journal then stops recording).
+bool journal_append(JournalWriter& w, const JournalRecord& rec);
+
+// Trims the file to the records written and unmaps it.
+void journal_close(JournalWriter& w);
+
+struct JournalReader {
+    int fd = -1;
+    const JournalHeader* header = nullptr;
+    const JournalRecord* records = nullptr;
+    uint64_t count = 0;
+    size_t mapped = 0;
+};
+
+// Maps `path` read-only; count is the published record count (a journal cut
+// short by a crash replays up to its last complete record).
+bool journal_open(JournalReader& r, const std::string& path);
+void journal_close(JournalReader& r);
+
+} // namespace casino
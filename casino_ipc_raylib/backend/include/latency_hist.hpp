@@ -0,0 +1,54 @@
+#pragma once
+
+#include "protocol.hpp"
+
+namespace casino {
+
+// Latency block at header.latencyOffset: the aggregate histograms
+// [LAT_STAGES][BET_VERDICTS], then capacity seats of [LAT_STAGES][SEAT_VERDICTS].
+constexpr uint64_t latency_block_histograms(uint32_t capacity) {
+    return static_cast<uint64_t>(LAT_STAGES) * BET_VERDICTS +
+           static_cast<uint64_t>(capacity) * LAT_STAGES * SEAT_VERDICTS;
+}
+
+inline LatencyHistogram* latency_block_of(SharedState* state) {
+    return reinterpret_cast<LatencyHistogram*>(reinterpret_cast<char*>(state) + state->header.latencyOffset);
+}
+
+inline const LatencyHistogram* latency_block_of(const SharedState* state) {
+    return reinterpret_cast<const LatencyHistogram*>(reinterpret_cast<const char*>(state) + state->header.latencyOffset);
+}
+
+inline size_t latency_index(int stage, int verdict) {
+    return static_cast<size_t>(stage) * BET_VERDICTS + static_cast<size_t>(verdict);
+}
+
+inline size_t latency_seat_index(int seat, int stage, int verdict) {
+    return static_cast<size_t>(LAT_STAGES) * BET_VERDICTS +
+           (static_cast<size_t>(seat) * LAT_STAGES + static_cast<size_t>(stage)) * SEAT_VERDICTS +
+           static_cast<size_t>(verdict);
+}
+
+// Bucket of a latency and the highest value that bucket holds.
+int latency_bucket(uint64_t ns);
+uint64_t latency_bucket_high(int bucket);
+
+// Owner only: constructs the `count` histograms of a block in place.
+void latency_block_init(LatencyHistogram* block, uint64_t count);
+
+// Single writer per histogram (the table's server thread).
+void latency_record(LatencyHistogram& h, uint64_t ns);
+
+struct LatencySummary {
+    uint64_t count = 0;
+    double meanNs = 0.0;
+    uint64_t p50Ns = 0;
+    uint64_t p99Ns = 0;
+    uint64_t p999Ns = 0;
+    uint64_t maxNs = 0;
+};
+
+// Live, lock-free read: percentiles are bucket upper bounds, capped at the max.
+LatencySummary latency_summarize(const LatencyHistogram& h);
+
+} // namespace casino
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "protocol.hpp"
+
+namespace casino {
+
+inline LockSiteProfile* lock_profile_of(SharedState* state) {
+    return reinterpret_cast<LockSiteProfile*>(reinterpret_cast<char*>(state) + state->header.lockProfileOffset);
+}
+
+inline const LockSiteProfile* lock_profile_of(const SharedState* state) {
+    return reinterpret_cast<const LockSiteProfile*>(reinterpret_cast<const char*>(state) +
+                                                    state->header.lockProfileOffset);
+}
+
+const char* lock_site_role(int site);
+const char* lock_site_name(int site);
+
+// Owner only: constructs the LOCK_SITES profiles in place.
+void lock_profile_init(LockSiteProfile* profiles);
+
+// One acquisition of state->mutex at `site`. With header.lockProfile off this
+// is safe_mutex_lock/pthread_mutex_unlock plus one branch.
+struct ProfiledLock {
+    SharedState* state = nullptr;
+    LockSiteProfile* profile = nullptr; // null when profiling is off
+    uint64_t acquiredNs = 0;
+};
+
+// Same contract as safe_mutex_lock (recovers an owner-dead robust mutex).
+bool profiled_lock(SharedState* state, LockSite site, ProfiledLock& lock);
+void profiled_unlock(ProfiledLock& lock);
+
+} // namespace casino
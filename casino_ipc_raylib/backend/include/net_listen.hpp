@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+
+namespace casino {
+
+// Listening sockets of the network-facing tools (exporter, gateway). `tag`
+// prefixes the error messages. Both return the fd (SOCK_CLOEXEC, plus
+// SOCK_NONBLOCK with `nonBlocking`) or -1.
+
+// `spec` is [addr:]port; the address defaults to 127.0.0.1. Sets SO_REUSEADDR.
+int listen_tcp(const std::string& spec, const char* tag, int backlog = 16, bool nonBlocking = false);
+
+// Replaces a stale socket file at `path`.
+int listen_unix(const std::string& path, const char* tag, int backlog = 16, bool nonBlocking = false);
+
+} // namespace casino
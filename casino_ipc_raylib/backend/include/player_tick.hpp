@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+namespace casino {
+
+// One animation step over per-seat arrays: advances spinProgress of spinning
+// seats by dProgress (ending the spin at 1.0) and decays pulse by dPulse.
+// Branch-free over contiguous arrays so the compiler vectorizes it. Returns
+// true while any seat still animates (spinning or pulse > 0). The server no
+// longer ticks animations (readers evaluate the published stamps, see
+// spin_progress_at); kept as the SoA baseline of bench_players.
+bool advance_players(float* __restrict spinProgress, float* __restrict pulse, int32_t* __restrict spinning,
+                     int count, float dProgress, float dPulse);
+
+} // namespace casino
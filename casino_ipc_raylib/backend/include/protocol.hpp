@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <pthread.h>
 
@@ -7,8 +9,48 @@ namespace casino {
 
 constexpr const char* SHM_NAME = "/casino_ipc_shared";
 constexpr const char* MQ_NAME = "/casino_ipc_mq";
-constexpr const char* SEM_NAME = "/casino_ipc_sem";
-constexpr int MAX_PLAYERS = 16;
+constexpr const char* SEM_NAME = "/casino_ipc_sem"; // legacy, only unlinked
+constexpr int DEFAULT_PLAYERS = 16;
+constexpr int MAX_TABLES = 64; // table t > 0 suffixes its IPC names with ".t<t>"
+// When set, every process maps this file (".t<t>" for t > 0) instead of the
+// POSIX shm object: the state then survives server restarts (casino_server --state-file).
+constexpr const char* STATE_FILE_ENV = "CASINO_STATE_FILE";
+
+// Segment layout: SharedState (header + counters), the PlayerSeat array, the hot
+// per-seat arrays, the bet ring, the spin event ring, the latency histograms and
+// the lock profile; capacity is chosen by the server at ftruncate time.
+constexpr uint32_t SHM_MAGIC = 0x43415349;  // "CASI"
+constexpr uint32_t SHM_ABI_VERSION = 18;     // bump on any layout change
+constexpr uint32_t DEFAULT_BET_RING_SLOTS = 4096; // power of two
+constexpr uint64_t BET_SLOT_ABANDON_NS = 250'000'000; // claimed ring ticket stalled this long: skipped (if its writer is dead)
+constexpr uint32_t DEFAULT_EVENT_RING_SLOTS = 1024; // power of two
+constexpr int SPIN_DURATION_MS = 2000; // a spin animates (spinProgress 0 -> 1) this long after its event
+constexpr float PULSE_DECAY_PER_S = 0.6f; // pulse falls linearly from its peak at this rate
+constexpr int BATCH_HIST_BUCKETS = 16; // bucket k: commits of [2^k, 2^(k+1)) spins
+constexpr uint32_t SEAT_GROUP = 64; // seats summarised by one group change stamp
+
+// How players hand bets to the server. The ring is the default; the POSIX MQ
+// (polled through epoll by the server) is kept as a fallback selected with --bets mq.
+enum BetTransport : uint32_t {
+    BET_TRANSPORT_RING = 0,
+    BET_TRANSPORT_MQ = 1,
+};
+
+// Bet wire protocol spoken over either transport (see BetFrame). The server
+// advertises the versions it accepts in the header; senders pick theirs there.
+constexpr uint32_t BET_PROTOCOL_VERSION = 1;
+constexpr int BET_FRAME_MAX = 8; // bets per frame
+
+// Knobs chosen by the owner; every offset in the header derives from the sizes,
+// and all of it is in the header before the magic is published.
+struct SegmentConfig {
+    uint32_t capacity = DEFAULT_PLAYERS;
+    uint32_t betRingSlots = DEFAULT_BET_RING_SLOTS;
+    uint32_t tableId = 0;
+    uint32_t tableCount = 1;
+    uint32_t eventRingSlots = DEFAULT_EVENT_RING_SLOTS;
+    uint32_t lockProfile = 0; // 1: time every acquisition of `mutex` (casino_server --lock-profile)
+};
 
 enum AnimState : int32_t {
     ANIM_IDLE = 0,
@@ -17,6 +59,22 @@ enum AnimState : int32_t {
     ANIM_LOSE = 3,
 };
 
+// Cold per-seat record (AoS): rewritten by the server only when a spin lands.
+// The per-tick fields and the player-written pid live in separate arrays (see
+// PlayerArrays) so the tick loop and player processes never share its lines.
+struct PlayerSeat {
+    int32_t id = -1;
+    float x = 0.0f;
+    float y = 0.0f;
+    int32_t animState = ANIM_IDLE;
+    int32_t symbols[3] = {0, 1, 2}; // last slot reel symbols
+    int32_t lastDelta = 0;          // win (+) or cost (-)
+    int32_t lastPayout = 0;
+    uint64_t nextAllowedNs = 0;     // CLOCK_MONOTONIC end of the seat's cooldown: bets before it wait in a pending slot
+};
+
+// Merged view of one seat (cold record + hot fields + pid), as copied out of
+// the segment by readers. Not a shared-memory layout.
 struct PlayerState {
     int32_t id = -1;
     float x = 0.0f;
@@ -29,27 +87,350 @@ struct PlayerState {
     float spinProgress = 0.0f;      // 0..1 over 3s window
     int32_t lastPayout = 0;
     int32_t pid = -1;               // player process id (written by player)
+    // published stamps the three animation fields above derive from (animate_player)
+    uint64_t spinStartNs = 0;
+    uint64_t pulseStartNs = 0;
+    float pulsePeak = 0.0f;
+};
+
+// Seqlock counter: odd while a writer is publishing, even when the state is consistent.
+// Writers still serialise on `mutex`; readers never take it (see read_consistent()).
+using SeqCounter = std::atomic<uint32_t>;
+static_assert(SeqCounter::is_always_lock_free, "seqlock counter must be lock-free to live in SHM");
+
+// Versioned header, written once by the owner before `magic` is published.
+// Attachers size their mapping from segmentSize and refuse unknown ABIs.
+struct SegmentHeader {
+    std::atomic<uint32_t> magic{0}; // SHM_MAGIC once the segment is initialised
+    uint32_t abiVersion = 0;
+    uint32_t headerSize = 0;        // sizeof(SharedState)
+    uint32_t playerStride = 0;      // sizeof(PlayerSeat)
+    uint32_t capacity = 0;          // number of PlayerState slots
+    uint32_t betRingSlots = 0;      // BetSlot entries after the BetRing header
+    uint32_t betTransport = BET_TRANSPORT_RING;
+    uint32_t tableId = 0;           // which table this segment serves
+    uint32_t tableCount = 1;        // tables run by the server (players route on it)
+    uint32_t eventRingSlots = 0;    // EventSlot entries after the EventRing header
+    uint32_t lockProfile = 0;       // 1 while lockers record into the lock profile
+    std::atomic<uint32_t> clean{0}; // file-backed: 1 after a clean shutdown, 0 while a server runs
+    uint32_t betProtocolMin = 0;    // bet frame versions the server decodes
+    uint32_t betProtocolMax = 0;
+    uint64_t playersOffset = 0;     // byte offset of the PlayerSeat array from segment start
+    // Hot SoA arrays (capacity entries each, every array starts on its own cache
+    // line): server-written once per spin, then the player-written pids.
+    uint64_t spinStartOffset = 0;   // uint64_t[capacity], CLOCK_MONOTONIC ns, 0: never spun
+    uint64_t pulseStartOffset = 0;  // uint64_t[capacity], CLOCK_MONOTONIC ns
+    uint64_t pulsePeakOffset = 0;   // float[capacity]
+    uint64_t pidOffset = 0;         // int32_t[capacity]
+    uint64_t spinDurationNs = 0;    // spinProgress runs 0 -> 1 over this from spinStart
+    // Change stamps (see mark_seat_changed): the generation that last modified
+    // each seat, and the latest one of each group of SEAT_GROUP seats
+    uint64_t seatGenOffset = 0;     // uint32_t[capacity]
+    uint64_t groupGenOffset = 0;    // uint32_t[ceil(capacity / SEAT_GROUP)]
+    uint64_t betRingOffset = 0;     // byte offset of the BetRing
+    uint64_t eventRingOffset = 0;   // byte offset of the EventRing
+    uint64_t latencyOffset = 0;     // byte offset of the LatencyHistogram block
+    uint64_t lockProfileOffset = 0; // byte offset of the LockSiteProfile array
+    uint64_t segmentSize = 0;       // total mapped bytes
+    std::atomic<uint64_t> epoch{0}; // bumped each time a server (re)starts on the segment
+    uint64_t checksum = 0;          // header_checksum() of the layout fields above
 };
 
 struct SharedState {
-    pthread_mutex_t mutex; // process-shared
+    SegmentHeader header;
+    pthread_mutex_t mutex; // process-shared, serialises writers only
+    SeqCounter seq{0};     // bumped around every write section
+    std::atomic<uint32_t> generation{0}; // +1 per publish; futex word of wait_state_change
     uint64_t tick = 0;
     int64_t jackpot = 0;
     int32_t rounds = 0;
-    int32_t lastWinnerId = -1;
+    int32_t lastWinnerId = -1; // global player id (PlayerSeat::id) of the last winning spin
     int32_t lastWinAmount = 0;
-    int32_t playerCount = 0;
-    PlayerState players[MAX_PLAYERS];
+    int32_t playerCount = 0;  // active seats, <= header.capacity
     // Instrumentation fields for viewer diagnostics
     int32_t mutex_held = 0;   // set to 1 by server while holding the mutex
     uint64_t mutex_last_held_ts = 0; // epoch ms when mutex was last held by server
-    int32_t sem_value = 0;    // last observed semaphore value
-    int32_t mq_count = 0;     // last observed number of messages in MQ
+    int32_t bet_depth = 0;    // pending bets: ring depth, or MQ curmsgs with --bets mq
+    uint64_t bet_overflows = 0; // bets rejected because the ring was full
+    uint64_t bet_wakeups = 0;   // futex wakes producers issued to a parked server
+    uint64_t bet_abandoned = 0; // ring tickets a producer claimed but never published (died mid-push)
+    // Bets that arrived during their seat's cooldown: held in the seat's pending
+    // slot (spun when the cooldown ends), folded into an already held bet, or
+    // dropped because they waited longer than --bet-ttl-ms
+    uint64_t bet_deferred = 0;
+    uint64_t bet_coalesced = 0;
+    uint64_t bet_expired = 0;
+    // Frame decoding: frames drained, sequence numbers skipped or replayed by
+    // their sender (duplicates are dropped), frames with an unknown version or count
+    uint64_t bet_frames = 0;
+    uint64_t bet_seq_gaps = 0;
+    uint64_t bet_seq_dups = 0;
+    uint64_t bet_bad_frames = 0;
+    // Batch commit distribution: every loop applies all its spins in one critical section
+    uint64_t batch_commits = 0;                   // commits that applied at least one spin
+    uint32_t batch_max = 0;                       // largest batch seen
+    uint64_t batch_hist[BATCH_HIST_BUCKETS] = {}; // last bucket is open-ended
+};
+
+// Animation state derived from the published stamps at the reader's `nowNs`
+// (same clock): nothing is written while a spin plays out.
+inline float spin_progress_at(uint64_t startNs, uint64_t durationNs, uint64_t nowNs) {
+    if (startNs == 0) return 1.0f;
+    if (nowNs <= startNs) return 0.0f;
+    if (durationNs == 0 || nowNs - startNs >= durationNs) return 1.0f;
+    return static_cast<float>(static_cast<double>(nowNs - startNs) / static_cast<double>(durationNs));
+}
+
+inline float pulse_at(float peak, uint64_t startNs, uint64_t nowNs) {
+    if (startNs == 0) return 0.0f;
+    const float elapsed = nowNs > startNs ? static_cast<float>(static_cast<double>(nowNs - startNs) * 1e-9) : 0.0f;
+    return std::max(0.0f, peak - PULSE_DECAY_PER_S * elapsed);
+}
+
+// Re-evaluates a copied seat's animation at nowNs. True while it still
+// animates (spinning or glowing): later frames must evaluate it again.
+inline bool animate_player(PlayerState& p, uint64_t durationNs, uint64_t nowNs) {
+    p.spinProgress = spin_progress_at(p.spinStartNs, durationNs, nowNs);
+    p.spinning = p.spinProgress < 1.0f ? 1 : 0;
+    p.pulse = pulse_at(p.pulsePeak, p.pulseStartNs, nowNs);
+    return p.spinning || p.pulse > 0.0f;
+}
+
+// Typed views over the per-seat arrays of a segment.
+struct PlayerArrays {
+    PlayerSeat* seats = nullptr;
+    uint64_t* spinStartNs = nullptr;
+    uint64_t* pulseStartNs = nullptr;
+    float* pulsePeak = nullptr;
+    int32_t* pid = nullptr;
+    uint32_t* seatGen = nullptr;
+    uint32_t* groupGen = nullptr;
 };
 
+struct ConstPlayerArrays {
+    const PlayerSeat* seats = nullptr;
+    const uint64_t* spinStartNs = nullptr;
+    const uint64_t* pulseStartNs = nullptr;
+    const float* pulsePeak = nullptr;
+    const int32_t* pid = nullptr;
+    const uint32_t* seatGen = nullptr;
+    const uint32_t* groupGen = nullptr;
+    uint64_t spinDurationNs = 0;
+
+    // One record per seat, animation evaluated at nowNs.
+    PlayerState load(int i, uint64_t nowNs) const {
+        PlayerState p{};
+        const PlayerSeat& s = seats[i];
+        p.id = s.id;
+        p.x = s.x;
+        p.y = s.y;
+        p.animState = s.animState;
+        p.symbols[0] = s.symbols[0];
+        p.symbols[1] = s.symbols[1];
+        p.symbols[2] = s.symbols[2];
+        p.lastDelta = s.lastDelta;
+        p.lastPayout = s.lastPayout;
+        p.spinStartNs = spinStartNs[i];
+        p.pulseStartNs = pulseStartNs[i];
+        p.pulsePeak = pulsePeak[i];
+        animate_player(p, spinDurationNs, nowNs);
+        p.pid = pid[i];
+        return p;
+    }
+};
+
+inline PlayerArrays players_of(SharedState* state) {
+    char* base = reinterpret_cast<char*>(state);
+    const SegmentHeader& h = state->header;
+    return PlayerArrays{reinterpret_cast<PlayerSeat*>(base + h.playersOffset),
+                        reinterpret_cast<uint64_t*>(base + h.spinStartOffset),
+                        reinterpret_cast<uint64_t*>(base + h.pulseStartOffset),
+                        reinterpret_cast<float*>(base + h.pulsePeakOffset),
+                        reinterpret_cast<int32_t*>(base + h.pidOffset),
+                        reinterpret_cast<uint32_t*>(base + h.seatGenOffset),
+                        reinterpret_cast<uint32_t*>(base + h.groupGenOffset)};
+}
+
+inline ConstPlayerArrays players_of(const SharedState* state) {
+    const char* base = reinterpret_cast<const char*>(state);
+    const SegmentHeader& h = state->header;
+    return ConstPlayerArrays{reinterpret_cast<const PlayerSeat*>(base + h.playersOffset),
+                             reinterpret_cast<const uint64_t*>(base + h.spinStartOffset),
+                             reinterpret_cast<const uint64_t*>(base + h.pulseStartOffset),
+                             reinterpret_cast<const float*>(base + h.pulsePeakOffset),
+                             reinterpret_cast<const int32_t*>(base + h.pidOffset),
+                             reinterpret_cast<const uint32_t*>(base + h.seatGenOffset),
+                             reinterpret_cast<const uint32_t*>(base + h.groupGenOffset),
+                             h.spinDurationNs};
+}
+
+// One bet of a frame.
+struct BetEntry {
+    int32_t playerId = -1; // seat index within the table
+    int32_t amount = 0;    // stake (a spin costs SPIN_COST whatever the amount)
+    int32_t spins = 1;     // 1: one spin; K > 1: autoplay K spins, one per cooldown; 0: stop autoplay
+};
+
+// Unit of the bet channel: one ring slot or MQ message carries up to
+// BET_FRAME_MAX bets, so a high-rate sender pays one publish (and at most one
+// wakeup) per frame. `seq` counts the frames of one `sender` from 1; the
+// server counts gaps and drops duplicates.
+struct BetFrame {
+    uint16_t version = BET_PROTOCOL_VERSION;
+    uint16_t count = 0;  // entries used in bets[]
+    uint32_t sender = 0; // scope of seq: one per sending process or thread
+    uint32_t seq = 0;
+    uint32_t reserved = 0;
+    uint64_t sentNs = 0; // CLOCK_MONOTONIC at send (stamped by send_bets)
+    BetEntry bets[BET_FRAME_MAX];
+};
+
+// One bet as the table logic sees it, decoded from a frame.
 struct BetMessage {
     int32_t playerId;
     int32_t amount;
+    uint64_t sentNs;   // of its frame
+    int32_t spins = 1; // BetEntry::spins
+    // bet id, carried into the SpinEvent it starts: frame sender and seq, index in the frame
+    uint32_t sender = 0;
+    uint32_t seq = 0;
+    int32_t index = 0;
+};
+
+// Ring entry. seq == ticket while free for that ticket, ticket | BET_SLOT_WRITING
+// while its producer copies the frame, ticket + 1 once filled. The server skips
+// (seq moved straight to ticket + slots) a ticket still free after
+// BET_SLOT_ABANDON_NS, and a writing one only once `writer` is dead: a copy in
+// flight is never handed to the next lap.
+constexpr uint64_t BET_SLOT_WRITING = 1ull << 63;
+struct BetSlot {
+    std::atomic<uint64_t> seq{0};
+    std::atomic<int32_t> writer{0}; // pid of the producer that claimed the slot for writing
+    BetFrame frame{};
+};
+
+// Bounded multi-producer/single-consumer bet ring living at header.betRingOffset,
+// immediately followed by header.betRingSlots BetSlot entries. Producers claim
+// tickets with a CAS on `tail` and never enter the kernel unless the server has
+// parked itself on the `wakeSeq` futex (consumerIdle == 1).
+struct BetRing {
+    alignas(64) std::atomic<uint64_t> tail{0};    // next producer ticket
+    alignas(64) std::atomic<uint64_t> head{0};    // next ticket the server consumes
+    alignas(64) std::atomic<uint32_t> wakeSeq{0}; // futex word
+    std::atomic<uint32_t> consumerIdle{0};        // 1 while the server sleeps on wakeSeq
+    std::atomic<uint64_t> overflows{0};           // pushes rejected because the ring was full
+    std::atomic<uint64_t> wakeups{0};             // futex wakes issued by producers
+    std::atomic<uint64_t> abandoned{0};           // claimed tickets skipped (producer stalled or dead)
+    // consumer only: seq + 1 of the claimed-but-unpublished slot blocking the
+    // head as last seen (0: none), and since when it has been in that state
+    std::atomic<uint64_t> stallTicket{0};
+    std::atomic<uint64_t> stallSinceNs{0};
+    uint32_t slots = 0;                           // power of two
+    uint32_t mask = 0;
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "bet ring counters must be lock-free to live in SHM");
+
+// Bet-to-pixel trace of a spin started by a bet: where the time went from the
+// player's send to the first viewer frame showing its result. The server fills
+// the first TRACE_SERVER_STAGES in the SpinEvent, each viewer the rest.
+enum TraceStage : int {
+    TRACE_QUEUE = 0,   // send -> the table loop finished the iteration it was busy with
+    TRACE_WAKEUP = 1,  // -> the loop woke up (doorbell, futex or timer wakeup)
+    TRACE_ROLL = 2,    // -> bets drained and rolled, commit lock requested
+    TRACE_LOCK = 3,    // -> spin published (lock wait and critical section)
+    TRACE_POLL = 4,    // -> a viewer's snapshot picked the event up
+    TRACE_PRESENT = 5, // -> the first frame revealing the result (reels stopped) was presented
+    TRACE_TOTAL = 6,   // send -> result presented
+    TRACE_STAGES = 7,
+};
+constexpr int TRACE_SERVER_STAGES = 4;
+
+// One landed spin, as broadcast to viewers and tools.
+struct SpinEvent {
+    int32_t playerId = -1; // global player id (PlayerSeat::id)
+    int32_t seat = -1;     // index in the segment's seat arrays
+    int32_t symbols[3] = {0, 0, 0};
+    int32_t delta = 0;     // payout - SPIN_COST
+    int32_t payout = 0;
+    int32_t betIndex = -1;    // bet id (BetMessage sender/seq/index); -1: untraced spin
+    uint64_t tick = 0;        // SharedState::tick the spin was committed at
+    uint64_t timestampNs = 0; // CLOCK_MONOTONIC of the commit
+    // trace of the bet that started the spin (held, autoplay and random spins have none)
+    uint32_t betSender = 0;
+    uint32_t betSeq = 0;
+    uint64_t sentNs = 0;      // the bet's send stamp
+    uint64_t publishedNs = 0; // CLOCK_MONOTONIC once the commit was published
+    uint32_t stageNs[TRACE_SERVER_STAGES] = {}; // TRACE_QUEUE..TRACE_LOCK, saturated
+};
+
+// Bet latency histograms (log-linear, HDR style): 2^LAT_SUB_BITS sub-buckets per
+// power of two, i.e. <= 12.5 % relative error; values >= 2^LAT_MAX_EXP ns
+// (~17 s) share the last bucket.
+constexpr int LAT_SUB_BITS = 3;
+constexpr int LAT_MAX_EXP = 34;
+constexpr int LAT_BUCKETS = (LAT_MAX_EXP - LAT_SUB_BITS + 1) << LAT_SUB_BITS;
+
+// Where a bet's time went: send -> drained by the server, drained -> result
+// published (or verdict reached), and send -> published.
+enum LatencyStage : int {
+    LAT_QUEUE = 0,
+    LAT_PROCESS = 1,
+    LAT_TOTAL = 2,
+    LAT_STAGES = 3,
+};
+
+// What the server did with a bet.
+enum BetVerdict : int {
+    BET_ACCEPTED = 0,
+    BET_COOLDOWN = 1, // seat still cooling down: held in (or coalesced into) its pending slot
+    BET_INVALID = 2,  // player id outside the table: dropped
+    BET_VERDICTS = 3,
+};
+constexpr int SEAT_VERDICTS = 2; // per-seat histograms: accepted and cooldown (invalid ids have no seat)
+
+// Written by the table's server thread only (relaxed load + store), read live
+// by any process without locking; a reader may see a bet in `count` before its
+// bucket, which percentiles tolerate.
+struct alignas(64) LatencyHistogram {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sumNs{0};
+    std::atomic<uint64_t> maxNs{0};
+    std::atomic<uint64_t> buckets[LAT_BUCKETS] = {};
+};
+
+// Every place that takes `mutex`, by process role. The viewer never locks (it
+// reads through the seqlock), so it has no site.
+enum LockSite : int {
+    LOCK_SITE_SERVER_INIT = 0,   // server: seat setup at table start
+    LOCK_SITE_SERVER_SPINS = 1,  // server: commit that applies spins
+    LOCK_SITE_SERVER_TICK = 2,   // server: commit without spins (deadline, expired bet)
+    LOCK_SITE_PLAYER_PID = 3,    // player: pid registration
+    LOCK_SITES = 4,
+};
+
+// Wait (lock call -> acquired) and hold (acquired -> unlock) times of one
+// site; hold.count is its acquisition count. Recorded while the mutex is still
+// held, so the mutex itself serialises the writers of every process.
+struct LockSiteProfile {
+    LatencyHistogram wait;
+    LatencyHistogram hold;
+};
+
+// Per-slot seqlock: seq == 2n + 1 while event n is being written into the slot,
+// 2n + 2 once it holds event n. One slot per cache line.
+struct alignas(64) EventSlot {
+    std::atomic<uint64_t> seq{0};
+    SpinEvent ev{};
+};
+
+// Single-writer (the table's server thread), multi-reader broadcast ring at
+// header.eventRingOffset, followed by header.eventRingSlots EventSlot entries.
+// The writer never waits for readers: each reader keeps its own cursor and
+// detects the events it was lapped on.
+struct EventRing {
+    alignas(64) std::atomic<uint64_t> head{0}; // events published so far
+    uint32_t slots = 0;                        // power of two
+    uint32_t mask = 0;
 };
 
 } // namespace casino
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace casino {
+
+// Slot rules shared by the server and the offline tools.
+constexpr int SYMBOL_COUNT = 4;
+constexpr int REEL_COUNT = 3;
+constexpr int SPIN_COST = 20;
+// weights for symbols: 7 (rare), diamond, bell, strawberry (common)
+constexpr uint32_t SYMBOL_WEIGHTS[SYMBOL_COUNT] = {1, 3, 5, 8};
+constexpr int32_t SYMBOL_PAYOUTS[SYMBOL_COUNT] = {400, 220, 140, 90};
+
+// Payout of one spin: three identical symbols pay that symbol, anything else 0.
+inline int32_t spin_payout(const uint8_t stops[REEL_COUNT]) {
+    return (stops[0] == stops[1] && stops[1] == stops[2]) ? SYMBOL_PAYOUTS[stops[0]] : 0;
+}
+
+// xoshiro256** with BATCH_RNG_LANES independent streams stored lane-major
+// (s[word][lane]) so one step updates every lane with the same instructions.
+// Output order is fixed (round by round, lane by lane): a seed always yields
+// the same sequence, whatever the batch sizes asked for.
+constexpr int BATCH_RNG_LANES = 8;
+
+struct BatchRng {
+    alignas(64) uint64_t s[4][BATCH_RNG_LANES];
+    uint64_t buffered[BATCH_RNG_LANES]; // last round, consumed before stepping again
+    int next = BATCH_RNG_LANES;         // index of the next unread buffered value
+};
+
+// Expands `seed` with splitmix64 into every lane (never all-zero).
+void batch_rng_seed(BatchRng& rng, uint64_t seed);
+
+// Writes the next n 64-bit values of the stream into out.
+void batch_rng_fill(BatchRng& rng, uint64_t* out, size_t n);
+
+// Walker/Vose alias table over integer weights. Sampling needs one 64-bit
+// random: the high half picks a column (Lemire multiply-shift), the low half is
+// compared against the column's 32-bit threshold. Building uses integers only,
+// so a table is identical on every platform.
+struct AliasTable {
+    std::vector<uint32_t> threshold; // keep the column if low32 < threshold
+    std::vector<uint8_t> alias;      // otherwise take this symbol
+    uint32_t size = 0;
+};
+
+// False if weights is empty, has more than 256 entries, or sums to 0 or to 2^32 or more.
+bool build_alias_table(const uint32_t* weights, uint32_t count, AliasTable& out);
+
+// Symbol for one random. Columns use Lemire's bounded multiply with its
+// rejection step; the rare rejected draw (probability < size / 2^32) is redrawn
+// from `retry`, a stream of its own, so the main stream never shifts.
+uint8_t sample_alias(const AliasTable& table, BatchRng& retry, uint64_t random);
+
+// Reel stops in bulk: stops[3 * i + r] is reel r of spin i. Results depend only
+// on the seed, not on how the spins are split into draw_stops calls.
+struct ReelSampler {
+    AliasTable reels[REEL_COUNT];
+    BatchRng rng;
+    BatchRng retry;
+    std::vector<uint64_t> scratch;
+};
+
+// Builds one alias table per reel from SYMBOL_WEIGHTS and seeds the generator.
+void reel_sampler_init(ReelSampler& sampler, uint64_t seed);
+
+void draw_stops(ReelSampler& sampler, uint8_t* stops, size_t spins);
+
+} // namespace casino
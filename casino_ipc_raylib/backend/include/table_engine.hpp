@@ -0,0 +1,138 @@
+#pragma once
+
+#include "protocol.hpp"
+#include "slot_math.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace casino {
+
+// Game logic of one table, shared by casino_server (live, --replay,
+// --virtual-time) and bench_hot, which times roll() and commit() on a private
+// segment.
+
+struct SpinTimers {
+    std::chrono::steady_clock::time_point nextAllowed;
+    float cooldownMin = 2.0f;
+    float cooldownMax = 5.0f;
+    std::chrono::steady_clock::time_point nextRandomStart;
+    bool pending = false; // a bet waits for nextAllowed
+    std::chrono::steady_clock::time_point pendingSince; // arrival of the latest bet folded into it
+    int32_t autoplay = 0; // spins left to play, one each time the cooldown ends
+
+    bool waiting() const { return pending || autoplay > 0; }
+};
+
+// Outcome of one spin, rolled outside the critical section.
+struct SpinOutcome {
+    int playerId = -1;
+    int symbols[3] = {0, 0, 0};
+    int payout = 0;
+    int delta = 0;
+    bool win = false;
+    uint64_t tick = 0; // set by commit
+    int bet = -1;      // index of the bet that started it in the roll's bets, -1 otherwise
+};
+
+// Loop stamps of one iteration (CLOCK_MONOTONIC ns), for the bet traces of its spins.
+struct LoopStamps {
+    uint64_t idleNs = 0; // the previous iteration ended and the loop started waiting
+    uint64_t wakeNs = 0; // the loop woke for this iteration
+};
+
+// Everything the commit publishes besides spins, sampled before locking so the
+// write section stays syscall-free.
+struct TickSample {
+    uint64_t wallMs = 0;      // epoch ms, mirrored into mutex_last_held_ts
+    int32_t betDepth = 0;
+    uint64_t betOverflows = 0;
+    uint64_t betWakeups = 0;
+    uint64_t betAbandoned = 0;
+    uint64_t betFrames = 0;
+    uint64_t betSeqGaps = 0;
+    uint64_t betSeqDups = 0;
+    uint64_t betBadFrames = 0;
+};
+
+// The part of the server command line the table logic depends on (and a
+// journal header records).
+struct EngineConfig {
+    unsigned int seed = 0;
+    int tables = 1;
+    bool randomStarts = true;
+    int betTtlMs = 5000; // a bet held through a cooldown expires after this (0: never)
+    BetTransport transport = BET_TRANSPORT_RING;
+};
+
+// Game logic of one table, driven by an explicit `now`. Every decision depends
+// only on the seed, the bets handed to roll() and the times they arrive at, so
+// a journal of those inputs re-executes it exactly (--replay). The caller owns
+// the clock, the event sources and the journal.
+struct TableEngine {
+    SharedState* state = nullptr;
+    PlayerArrays players{};
+    int playerCount = 0;
+    bool randomStarts = true;
+    std::mt19937 rng;
+    std::uniform_int_distribution<int> randomStart{1000, 4000};
+    std::vector<SpinTimers> timers;
+    uint64_t originNs = 0; // monotonic_stamp(start): the digest hashes spin stamps relative to it
+    ReelSampler reels;
+    std::vector<uint8_t> stops;
+    size_t nextStop = 0;
+    std::vector<SpinOutcome> batch; // spins rolled by the last roll(), in commit order
+    size_t betSpins = 0;            // batch[0, betSpins) came from bets, the rest are random starts
+    std::vector<uint8_t> verdicts;  // BetVerdict of each bet handed to the last roll()
+    std::chrono::nanoseconds betTtl{0}; // 0: held bets never expire
+    bool wakeReaders = true;        // false on private segments (replay, virtual time): nobody waits
+    int waitingSeats = 0;           // seats holding a bet or autoplay spins
+    uint64_t deferred = 0;          // published as bet_deferred / bet_coalesced / bet_expired
+    uint64_t coalesced = 0;
+    uint64_t expired = 0;
+
+    static constexpr size_t STOP_BATCH = 4096;
+
+    // Seeds the table and publishes its initial state; `start` is the time
+    // origin of every cooldown and deadline. An `adopted` segment keeps its
+    // jackpot, counters and seats (only ids and positions are rewritten); its
+    // spin stamps are cleared, they may come from another boot's clock.
+    void init(SharedState* s, const EngineConfig& cfg, int index, int seats,
+              std::chrono::steady_clock::time_point start, bool adopted = false);
+
+    static uint64_t monotonic_stamp(std::chrono::steady_clock::time_point t) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count());
+    }
+
+    SpinOutcome roll_spin(int playerId);
+
+    // Earliest cooldown end of a seat holding a bet or autoplay spins, or random start any seat
+    // is waiting for (a start needs both its random deadline and its cooldown
+    // to have passed); max() when idle. Animations need no wakeup: readers
+    // evaluate them from the published stamps.
+    std::chrono::steady_clock::time_point next_deadline() const;
+
+    // Starts seat pid's spin at `now` and its next cooldown.
+    void start_spin(int pid, std::chrono::steady_clock::time_point now);
+
+    // Rolls the held bets and autoplay spins whose cooldown ended, then every
+    // accepted bet (arrival order) and due random start at `now`, outside the
+    // lock. A bet during a cooldown is held in the seat's pending slot (one per
+    // seat: a later one is coalesced into it). An autoplay bet replaces the
+    // seat's remaining spins. True if the loop has something to publish.
+    bool roll(std::chrono::steady_clock::time_point now, const std::vector<BetMessage>& bets, bool timerFired);
+
+    // Single critical section per loop: every spin of the batch (in arrival
+    // order, so jackpot clamping is unchanged), stamped to start its animation
+    // at `now` and marked changed for the readers, and the instrumentation in
+    // `sample`. The spins are then broadcast on the event
+    // ring, after the lock (this thread is the ring's only writer), with the
+    // trace of the bet that started them when `bets` (the roll's) is given.
+    void commit(std::chrono::steady_clock::time_point now, TickSample sample,
+                const std::vector<BetMessage>* bets = nullptr, LoopStamps loop = {});
+};
+
+} // namespace casino
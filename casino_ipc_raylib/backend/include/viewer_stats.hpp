@@ -0,0 +1,71 @@
+#pragma once
+
+#include "protocol.hpp"
+
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace casino {
+
+// Frame statistics a viewer publishes for exporters, in its own small segment
+// (VIEWER_STATS_PREFIX + pid) so readers never touch the server's segment.
+// Single writer: the viewer's render thread (relaxed load + store).
+constexpr const char* VIEWER_STATS_PREFIX = "/casino_viewer.";
+constexpr uint32_t VIEWER_STATS_MAGIC = 0x57564943; // "CIVW"
+constexpr uint32_t VIEWER_STATS_VERSION = 2;
+
+struct ViewerStats {
+    std::atomic<uint32_t> magic{0}; // published last
+    uint32_t version = 0;
+    int32_t pid = -1;
+    int32_t table = 0;              // table shown (CASINO_TABLE)
+    std::atomic<uint32_t> attached{0}; // 1 while mapped on a live server segment
+    uint32_t reserved = 0;
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> seqlockReads{0};
+    std::atomic<uint64_t> seqlockRetries{0};
+    std::atomic<uint64_t> slowReads{0};
+    std::atomic<uint64_t> eventsRead{0};
+    std::atomic<uint64_t> eventsLost{0};
+    std::atomic<uint64_t> tracedSpins{0}; // bet-traced spins presented
+    LatencyHistogram frameTime; // time between frames (ns)
+    LatencyHistogram trace[TRACE_STAGES]; // bet-to-pixel stages of traced spins (ns)
+};
+
+// Viewer side: creates (truncates) the segment of this process; null on error.
+ViewerStats* viewer_stats_create(int table);
+// Unmaps and unlinks the segment of this process.
+void viewer_stats_destroy(ViewerStats* stats);
+
+// What the viewer has counted so far (totals since it started).
+struct ViewerFrameCounters {
+    bool attached = false;
+    uint64_t seqlockReads = 0;
+    uint64_t seqlockRetries = 0;
+    uint64_t slowReads = 0;
+    uint64_t eventsRead = 0;
+    uint64_t eventsLost = 0;
+};
+
+// Single writer: records one frame time and stores the counters.
+void viewer_stats_frame(ViewerStats* stats, uint64_t frameNs, const ViewerFrameCounters& c);
+
+// Single writer: files the trace of a spin polled at `polledNs` whose result
+// was first presented at `presentedNs` (untraced spins are ignored).
+void viewer_stats_trace(ViewerStats* stats, const SpinEvent& ev, uint64_t polledNs, uint64_t presentedNs);
+
+// "queue", "wakeup", ... for a TraceStage.
+const char* trace_stage_name(int stage);
+
+// Exporter side: read-only mappings of every viewer segment whose process is
+// still alive (segments of dead viewers are unlinked).
+struct ViewerStatsView {
+    std::string name;
+    const ViewerStats* stats = nullptr;
+    size_t size = 0;
+};
+std::vector<ViewerStatsView> viewer_stats_open_all();
+void viewer_stats_close_all(std::vector<ViewerStatsView>& views);
+
+} // namespace casino
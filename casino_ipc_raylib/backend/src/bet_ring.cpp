@@ -0,0 +1,187 @@
+#include "bet_ring.hpp"
+#include "ipc_shared.hpp"
+
+#include <cerrno>
+#include <new>
+#include <signal.h>
+#include <unistd.h>
+
+namespace casino {
+
+namespace {
+
+BetSlot* slots_of(BetRing* ring) { return reinterpret_cast<BetSlot*>(ring + 1); }
+
+const BetSlot* slots_of(const BetRing* ring) { return reinterpret_cast<const BetSlot*>(ring + 1); }
+
+constexpr uint64_t NO_STALL = UINT64_MAX;
+
+// Cached: getpid() is a syscall on current glibc. A child forked after its
+// parent pushed reports the parent's pid, which only delays an abandon.
+int32_t self_pid() {
+    static const int32_t pid = static_cast<int32_t>(getpid());
+    return pid;
+}
+
+bool writer_alive(const BetSlot& slot) {
+    int32_t pid = slot.writer.load(std::memory_order_acquire);
+    return pid > 0 && (kill(pid, 0) == 0 || errno != ESRCH);
+}
+
+// Consumer side. The slot at `head` is claimed (tail moved past it) but not yet
+// published: normally a producer between its CAS and its publish, or one that
+// died there and would block every bet behind it. Starts the abandon clock each
+// time the slot changes state (claimed -> writing restarts it); returns the ns
+// left before it may be skipped (0: skip now), or NO_STALL if the head slot is
+// not stalled. A writing slot is only skipped once its writer is dead: while it
+// lives, the clock restarts. `seen` receives the slot state the answer is for.
+uint64_t stall_remaining(BetRing* ring, uint64_t head, uint64_t* seen = nullptr) {
+    const BetSlot& slot = slots_of(ring)[head & ring->mask];
+    uint64_t seq = slot.seq.load(std::memory_order_acquire);
+    if (seen) *seen = seq;
+    if (seq != head && seq != (head | BET_SLOT_WRITING)) return NO_STALL;
+    if (seq == head && ring->tail.load(std::memory_order_relaxed) <= head) return NO_STALL;
+    uint64_t now = monotonic_ns();
+    if (ring->stallTicket.load(std::memory_order_relaxed) != seq + 1) {
+        ring->stallSinceNs.store(now, std::memory_order_relaxed);
+        ring->stallTicket.store(seq + 1, std::memory_order_relaxed);
+        return BET_SLOT_ABANDON_NS;
+    }
+    uint64_t waited = now - ring->stallSinceNs.load(std::memory_order_relaxed);
+    if (waited < BET_SLOT_ABANDON_NS) return BET_SLOT_ABANDON_NS - waited;
+    if ((seq & BET_SLOT_WRITING) && writer_alive(slot)) {
+        ring->stallSinceNs.store(now, std::memory_order_relaxed);
+        return BET_SLOT_ABANDON_NS;
+    }
+    return 0;
+}
+
+} // namespace
+
+void bet_ring_init(BetRing* ring, uint32_t slots) {
+    new (ring) BetRing();
+    ring->slots = slots;
+    ring->mask = slots - 1;
+    BetSlot* s = slots_of(ring);
+    for (uint32_t i = 0; i < slots; ++i) {
+        new (&s[i]) BetSlot();
+        s[i].seq.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool bet_ring_push(BetRing* ring, const BetFrame& frame) {
+    BetSlot* s = slots_of(ring);
+    uint64_t pos = ring->tail.load(std::memory_order_relaxed);
+    BetSlot* slot = nullptr;
+    while (true) {
+        slot = &s[pos & ring->mask];
+        uint64_t seq = slot->seq.load(std::memory_order_acquire);
+        // a slot being written for ticket t is already past t
+        if (seq & BET_SLOT_WRITING) seq = (seq & ~BET_SLOT_WRITING) + 1;
+        int64_t dif = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+        if (dif == 0) {
+            if (ring->tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (dif < 0) {
+            // slot still holds a bet from the previous lap: the server is behind
+            ring->overflows.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = ring->tail.load(std::memory_order_relaxed);
+        }
+    }
+    // Claim the slot for writing before copying: the server abandons a ticket
+    // left free past BET_SLOT_ABANDON_NS, but cannot take a writing slot from a
+    // live producer. If it already skipped our ticket (we stalled that long
+    // right after the tail CAS), the CAS fails and the bet is lost, untouched.
+    slot->writer.store(self_pid(), std::memory_order_relaxed);
+    uint64_t claimed = pos;
+    if (!slot->seq.compare_exchange_strong(claimed, pos | BET_SLOT_WRITING, std::memory_order_acq_rel,
+                                           std::memory_order_relaxed)) {
+        return false;
+    }
+    slot->frame = frame;
+    slot->seq.store(pos + 1, std::memory_order_release);
+
+    // Pairs with the fence in bet_ring_wait: either the server sees our slot
+    // before sleeping, or we see consumerIdle and wake it. Only the producer
+    // that clears the flag pays for the syscall.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (ring->consumerIdle.load(std::memory_order_relaxed) &&
+        ring->consumerIdle.exchange(0, std::memory_order_acq_rel)) {
+        ring->wakeSeq.fetch_add(1, std::memory_order_release);
+        futex_wake(&ring->wakeSeq, 1);
+        ring->wakeups.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+size_t bet_ring_drain(BetRing* ring, BetFrame* out, size_t max) {
+    BetSlot* s = slots_of(ring);
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    size_t n = 0;
+    while (n < max) {
+        BetSlot& slot = s[head & ring->mask];
+        uint64_t seq = slot.seq.load(std::memory_order_acquire);
+        if (seq != head + 1) {
+            if (stall_remaining(ring, head, &seq) != 0) break;
+            // claimed and never published (producer stalled before writing, or
+            // died): give the slot to the next lap and move on. The CAS fails
+            // if the producer moved on since that check; look again.
+            if (slot.seq.compare_exchange_strong(seq, head + ring->slots, std::memory_order_acq_rel)) {
+                ring->abandoned.fetch_add(1, std::memory_order_relaxed);
+                ++head;
+            }
+            continue;
+        }
+        out[n++] = slot.frame;
+        // hand the slot to the producer one lap ahead
+        slot.seq.store(head + ring->slots, std::memory_order_release);
+        ++head;
+    }
+    ring->head.store(head, std::memory_order_release);
+    return n;
+}
+
+void bet_ring_wait(BetRing* ring, int timeoutMs, const std::atomic<bool>* stop) {
+    ring->consumerIdle.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint32_t expected = ring->wakeSeq.load(std::memory_order_acquire);
+    // A kick that bumped wakeSeq before the load above would not wake us: its
+    // stop request is visible by now, so check it instead of sleeping.
+    if (stop && stop->load(std::memory_order_relaxed)) {
+        ring->consumerIdle.store(0, std::memory_order_relaxed);
+        return;
+    }
+    if (!bet_ring_pending(ring)) {
+        // a stalled ticket blocks the head: wake up in time to skip it
+        uint64_t left = stall_remaining(ring, ring->head.load(std::memory_order_relaxed));
+        if (left != NO_STALL) {
+            int capMs = static_cast<int>(left / 1'000'000) + 1;
+            if (timeoutMs < 0 || capMs < timeoutMs) timeoutMs = capMs;
+        }
+        futex_wait(&ring->wakeSeq, expected, timeoutMs);
+    }
+    ring->consumerIdle.store(0, std::memory_order_relaxed);
+}
+
+bool bet_ring_pending(const BetRing* ring) {
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    if (slots_of(ring)[head & ring->mask].seq.load(std::memory_order_acquire) == head + 1) return true;
+    // a stalled ticket whose abandon deadline ran out is work too: drain skips it
+    uint64_t stalled = ring->stallTicket.load(std::memory_order_relaxed);
+    return (stalled == head + 1 || stalled == (head | BET_SLOT_WRITING) + 1) &&
+           monotonic_ns() - ring->stallSinceNs.load(std::memory_order_relaxed) >= BET_SLOT_ABANDON_NS;
+}
+
+void bet_ring_kick(BetRing* ring) {
+    ring->wakeSeq.fetch_add(1, std::memory_order_release);
+    futex_wake(&ring->wakeSeq, 1);
+}
+
+uint64_t bet_ring_depth(const BetRing* ring) {
+    uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    return tail > head ? tail - head : 0;
+}
+
+} // namespace casino
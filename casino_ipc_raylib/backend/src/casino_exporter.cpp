@@ -0,0 +1,448 @@
+// Prometheus text-format exporter of a running casino_server and its viewers.
+//
+//   casino_exporter [--listen [addr:]port | --unix PATH] [--once]
+//
+// Serves GET /metrics over HTTP on 127.0.0.1:9464 by default (or on a Unix
+// socket). Every scrape maps each table segment read-only, copies its counters
+// through the seqlock and unmaps it again: the server is never locked, woken or
+// signalled. Viewers are read from their own stats segments. --once prints a
+// single scrape to stdout and exits.
+#include "ipc_shared.hpp"
+#include "bet_ring.hpp"
+#include "event_ring.hpp"
+#include "latency_hist.hpp"
+#include "lock_profile.hpp"
+#include "net_listen.hpp"
+#include "viewer_stats.hpp"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void on_signal(int) { g_stop = 1; }
+
+constexpr const char* DEFAULT_LISTEN = "127.0.0.1:9464";
+
+const char* const STAGE_LABELS[casino::LAT_STAGES] = {"queue", "process", "total"};
+const char* const VERDICT_LABELS[casino::BET_VERDICTS] = {"accepted", "cooldown", "invalid"};
+
+uint64_t g_scrapes = 0;
+uint64_t g_readRetries = 0;  // seqlock retries across scrapes
+uint64_t g_readFailures = 0; // tables skipped: no stable sequence
+
+// Counters of one table, copied under the seqlock.
+struct TableCounters {
+    uint64_t tick = 0;
+    int64_t jackpot = 0;
+    int32_t rounds = 0;
+    int32_t playerCount = 0;
+    int32_t betDepth = 0;
+    uint64_t betOverflows = 0;
+    uint64_t betWakeups = 0;
+    uint64_t betAbandoned = 0;
+    uint64_t betDeferred = 0;
+    uint64_t betCoalesced = 0;
+    uint64_t betExpired = 0;
+    uint64_t betFrames = 0;
+    uint64_t betSeqGaps = 0;
+    uint64_t betSeqDups = 0;
+    uint64_t betBadFrames = 0;
+    uint64_t batchCommits = 0;
+    uint32_t batchMax = 0;
+    uint64_t batchHist[casino::BATCH_HIST_BUCKETS] = {};
+};
+
+struct TableScrape {
+    int table = 0;
+    casino::SharedHandle shm;
+    TableCounters c;
+};
+
+// Prometheus text exposition (format 0.0.4).
+struct Metrics {
+    std::string out;
+
+    void family(const char* name, const char* type, const char* help) {
+        out += "# HELP ";
+        out += name;
+        out += ' ';
+        out += help;
+        out += "\n# TYPE ";
+        out += name;
+        out += ' ';
+        out += type;
+        out += '\n';
+    }
+
+    void sample(const char* name, const std::string& labels, double value, const char* suffix = "") {
+        char buf[64];
+        // counters print as integers, timings with 9 significant digits
+        bool integral = value == static_cast<double>(static_cast<int64_t>(value)) && value < 9007199254740992.0 &&
+                        value > -9007199254740992.0;
+        std::snprintf(buf, sizeof(buf), integral ? "%.0f" : "%.9g", value);
+        out += name;
+        out += suffix;
+        if (!labels.empty()) {
+            out += '{';
+            out += labels;
+            out += '}';
+        }
+        out += ' ';
+        out += buf;
+        out += '\n';
+    }
+
+    // Summary from a shared histogram: bucket-bound quantiles, _sum and _count, in seconds.
+    void summary(const char* name, const std::string& labels, const casino::LatencyHistogram& h) {
+        casino::LatencySummary s = casino::latency_summarize(h);
+        const std::string sep = labels.empty() ? "" : ",";
+        sample(name, labels + sep + "quantile=\"0.5\"", static_cast<double>(s.p50Ns) / 1e9);
+        sample(name, labels + sep + "quantile=\"0.99\"", static_cast<double>(s.p99Ns) / 1e9);
+        sample(name, labels + sep + "quantile=\"0.999\"", static_cast<double>(s.p999Ns) / 1e9);
+        sample(name, labels, static_cast<double>(h.sumNs.load(std::memory_order_relaxed)) / 1e9, "_sum");
+        sample(name, labels, static_cast<double>(s.count), "_count");
+    }
+};
+
+std::string table_label(int table) { return "table=\"" + std::to_string(table) + "\""; }
+
+std::vector<TableScrape> open_tables() {
+    std::vector<TableScrape> tables;
+    auto first = casino::open_shared_memory_readonly(0);
+    if (!first) return tables;
+    int count = static_cast<int>(first->state->header.tableCount);
+    tables.push_back({0, *first, {}});
+    for (int t = 1; t < count && t < casino::MAX_TABLES; ++t) {
+        if (auto shm = casino::open_shared_memory_readonly(t)) tables.push_back({t, *shm, {}});
+    }
+    for (auto it = tables.begin(); it != tables.end();) {
+        const casino::SharedState* st = it->shm.state;
+        TableCounters& c = it->c;
+        int retries = casino::read_consistent(st, [&] {
+            c.tick = st->tick;
+            c.jackpot = st->jackpot;
+            c.rounds = st->rounds;
+            c.playerCount = st->playerCount;
+            c.betDepth = st->bet_depth;
+            c.betOverflows = st->bet_overflows;
+            c.betWakeups = st->bet_wakeups;
+            c.betAbandoned = st->bet_abandoned;
+            c.betDeferred = st->bet_deferred;
+            c.betCoalesced = st->bet_coalesced;
+            c.betExpired = st->bet_expired;
+            c.betFrames = st->bet_frames;
+            c.betSeqGaps = st->bet_seq_gaps;
+            c.betSeqDups = st->bet_seq_dups;
+            c.betBadFrames = st->bet_bad_frames;
+            c.batchCommits = st->batch_commits;
+            c.batchMax = st->batch_max;
+            std::memcpy(c.batchHist, st->batch_hist, sizeof(c.batchHist));
+        });
+        if (retries < 0) {
+            g_readFailures++;
+            casino::close_shared_memory(it->shm);
+            it = tables.erase(it);
+            continue;
+        }
+        g_readRetries += static_cast<uint64_t>(retries);
+        ++it;
+    }
+    return tables;
+}
+
+void table_metrics(Metrics& m, const std::vector<TableScrape>& tables) {
+    m.family("casino_up", "gauge", "1 if the table 0 segment of casino_server is mapped.");
+    m.sample("casino_up", "", tables.empty() ? 0 : 1);
+    if (tables.empty()) return;
+
+    m.family("casino_ticks_total", "counter", "State publications (commits and spins).");
+    for (const auto& t : tables) m.sample("casino_ticks_total", table_label(t.table), static_cast<double>(t.c.tick));
+    m.family("casino_rounds_total", "counter", "Spins committed.");
+    for (const auto& t : tables) m.sample("casino_rounds_total", table_label(t.table), t.c.rounds);
+    m.family("casino_jackpot", "gauge", "Shared bank of the table.");
+    for (const auto& t : tables) m.sample("casino_jackpot", table_label(t.table), static_cast<double>(t.c.jackpot));
+    m.family("casino_players", "gauge", "Active seats.");
+    for (const auto& t : tables) m.sample("casino_players", table_label(t.table), t.c.playerCount);
+
+    m.family("casino_bet_queue_depth", "gauge", "Pending bets in the ring (or MQ curmsgs with --bets mq).");
+    for (const auto& t : tables) m.sample("casino_bet_queue_depth", table_label(t.table), t.c.betDepth);
+    m.family("casino_bet_overflows_total", "counter", "Bets rejected because the bet channel was full.");
+    for (const auto& t : tables) {
+        m.sample("casino_bet_overflows_total", table_label(t.table), static_cast<double>(t.c.betOverflows));
+    }
+    m.family("casino_bet_wakeups_total", "counter", "Futex wakes producers paid because the server was parked.");
+    for (const auto& t : tables) {
+        m.sample("casino_bet_wakeups_total", table_label(t.table), static_cast<double>(t.c.betWakeups));
+    }
+    m.family("casino_bet_abandoned_total", "counter", "Ring tickets a producer claimed but never published, skipped by the server.");
+    for (const auto& t : tables) {
+        m.sample("casino_bet_abandoned_total", table_label(t.table), static_cast<double>(t.c.betAbandoned));
+    }
+    m.family("casino_bet_deferred_total", "counter", "Bets held in their seat's pending slot until its cooldown ended.");
+    for (const auto& t : tables) {
+        m.sample("casino_bet_deferred_total", table_label(t.table), static_cast<double>(t.c.betDeferred));
+    }
+    m.family("casino_bet_coalesced_total", "counter", "Bets folded into a bet already held for the same seat.");
+    for (const auto& t : tables) {
+        m.sample("casino_bet_coalesced_total", table_label(t.table), static_cast<double>(t.c.betCoalesced));
+    }
+    m.family("casino_bet_expired_total", "counter", "Held bets dropped after waiting longer than --bet-ttl-ms.");
+    for (const auto& t : tables) {
+        m.sample("casino_bet_expired_total", table_label(t.table), static_cast<double>(t.c.betExpired));
+    }
+    m.family("casino_bet_frames_total", "counter", "Bet frames drained (each carries up to 8 bets).");
+    for (const auto& t : tables) {
+        m.sample("casino_bet_frames_total", table_label(t.table), static_cast<double>(t.c.betFrames));
+    }
+    m.family("casino_bet_seq_gaps_total", "counter", "Frames missing from their sender's sequence.");
+    for (const auto& t : tables) {
+        m.sample("casino_bet_seq_gaps_total", table_label(t.table), static_cast<double>(t.c.betSeqGaps));
+    }
+    m.family("casino_bet_seq_dups_total", "counter", "Frames dropped because their sender had already sent that sequence number.");
+    for (const auto& t : tables) {
+        m.sample("casino_bet_seq_dups_total", table_label(t.table), static_cast<double>(t.c.betSeqDups));
+    }
+    m.family("casino_bet_bad_frames_total", "counter", "Frames dropped for an unknown protocol version or bet count.");
+    for (const auto& t : tables) {
+        m.sample("casino_bet_bad_frames_total", table_label(t.table), static_cast<double>(t.c.betBadFrames));
+    }
+    m.family("casino_server_parked", "gauge", "1 while the table thread sleeps on the bet ring futex.");
+    for (const auto& t : tables) {
+        const casino::SharedState* st = t.shm.state;
+        if (st->header.betTransport != casino::BET_TRANSPORT_RING) continue;
+        m.sample("casino_server_parked", table_label(t.table),
+                 casino::bet_ring_of(st)->consumerIdle.load(std::memory_order_relaxed));
+    }
+    m.family("casino_spin_events_total", "counter", "Spin events published on the event ring.");
+    for (const auto& t : tables) {
+        m.sample("casino_spin_events_total", table_label(t.table),
+                 static_cast<double>(casino::event_ring_of(t.shm.state)->head.load(std::memory_order_acquire)));
+    }
+
+    m.family("casino_batch_commits_total", "counter", "Critical sections that applied at least one spin.");
+    for (const auto& t : tables) {
+        m.sample("casino_batch_commits_total", table_label(t.table), static_cast<double>(t.c.batchCommits));
+    }
+    m.family("casino_batch_max", "gauge", "Largest batch of spins applied in one commit.");
+    for (const auto& t : tables) m.sample("casino_batch_max", table_label(t.table), t.c.batchMax);
+    // batch_hist[k] counts commits of [2^k, 2^(k+1)) spins: cumulative buckets le = 2^(k+1) - 1
+    m.family("casino_batch_spins", "histogram", "Spins applied per commit.");
+    for (const auto& t : tables) {
+        uint64_t cumulative = 0;
+        for (int k = 0; k < casino::BATCH_HIST_BUCKETS; ++k) {
+            cumulative += t.c.batchHist[k];
+            std::string le = k + 1 < casino::BATCH_HIST_BUCKETS ? std::to_string((1ull << (k + 1)) - 1) : "+Inf";
+            m.sample("casino_batch_spins", table_label(t.table) + ",le=\"" + le + "\"", static_cast<double>(cumulative),
+                     "_bucket");
+        }
+        m.sample("casino_batch_spins", table_label(t.table), t.c.rounds, "_sum");
+        m.sample("casino_batch_spins", table_label(t.table), static_cast<double>(t.c.batchCommits), "_count");
+    }
+
+    // Verdicts and latencies come straight from the live histograms (single writer, no lock)
+    m.family("casino_bets_total", "counter", "Bets drained by the server, by verdict (cooldown and invalid are dropped).");
+    for (const auto& t : tables) {
+        const casino::LatencyHistogram* block = casino::latency_block_of(t.shm.state);
+        for (int v = 0; v < casino::BET_VERDICTS; ++v) {
+            const auto& h = block[casino::latency_index(casino::LAT_TOTAL, v)];
+            m.sample("casino_bets_total", table_label(t.table) + ",verdict=\"" + VERDICT_LABELS[v] + "\"",
+                     static_cast<double>(h.count.load(std::memory_order_acquire)));
+        }
+    }
+    m.family("casino_bet_latency_seconds", "summary", "Bet latency by stage (send -> drained -> published).");
+    for (const auto& t : tables) {
+        const casino::LatencyHistogram* block = casino::latency_block_of(t.shm.state);
+        for (int stage = 0; stage < casino::LAT_STAGES; ++stage) {
+            for (int v = 0; v < casino::BET_VERDICTS; ++v) {
+                m.summary("casino_bet_latency_seconds",
+                          table_label(t.table) + ",stage=\"" + STAGE_LABELS[stage] + "\",verdict=\"" +
+                              VERDICT_LABELS[v] + "\"",
+                          block[casino::latency_index(stage, v)]);
+            }
+        }
+    }
+    // Per player: seats that have seen at least one bet
+    m.family("casino_player_bets_total", "counter", "Bets of one player, accepted (spins) or dropped on cooldown.");
+    for (const auto& t : tables) {
+        const casino::SharedState* st = t.shm.state;
+        const casino::LatencyHistogram* block = casino::latency_block_of(st);
+        const int tableCount = static_cast<int>(st->header.tableCount);
+        for (int seat = 0; seat < t.c.playerCount && static_cast<uint32_t>(seat) < st->header.capacity; ++seat) {
+            for (int v = 0; v < casino::SEAT_VERDICTS; ++v) {
+                uint64_t n = block[casino::latency_seat_index(seat, casino::LAT_TOTAL, v)].count.load(
+                    std::memory_order_acquire);
+                if (n == 0) continue;
+                m.sample("casino_player_bets_total",
+                         table_label(t.table) + ",player=\"" + std::to_string(seat * tableCount + t.table) +
+                             "\",verdict=\"" + VERDICT_LABELS[v] + "\"",
+                         static_cast<double>(n));
+            }
+        }
+    }
+
+    // Lock contention, only while the server runs --lock-profile
+    bool profiled = false;
+    for (const auto& t : tables) profiled = profiled || t.shm.state->header.lockProfile;
+    if (!profiled) return;
+    for (int kind = 0; kind < 2; ++kind) {
+        const char* name = kind == 0 ? "casino_lock_wait_seconds" : "casino_lock_hold_seconds";
+        m.family(name, "summary",
+                 kind == 0 ? "Time to acquire the segment mutex, by site." : "Time the segment mutex was held, by site.");
+        for (const auto& t : tables) {
+            if (!t.shm.state->header.lockProfile) continue;
+            const casino::LockSiteProfile* profiles = casino::lock_profile_of(t.shm.state);
+            for (int site = 0; site < casino::LOCK_SITES; ++site) {
+                m.summary(name,
+                          table_label(t.table) + ",role=\"" + casino::lock_site_role(site) + "\",site=\"" +
+                              casino::lock_site_name(site) + "\"",
+                          kind == 0 ? profiles[site].wait : profiles[site].hold);
+            }
+        }
+    }
+}
+
+void viewer_metrics(Metrics& m) {
+    std::vector<casino::ViewerStatsView> views = casino::viewer_stats_open_all();
+    m.family("casino_viewers", "gauge", "Running viewers publishing frame statistics.");
+    m.sample("casino_viewers", "", static_cast<double>(views.size()));
+    if (views.empty()) return;
+    auto labels = [](const casino::ViewerStats* v) {
+        return "pid=\"" + std::to_string(v->pid) + "\"," + table_label(v->table);
+    };
+    auto counter = [&](const char* name, const char* help, auto field) {
+        m.family(name, "counter", help);
+        for (const auto& v : views) {
+            m.sample(name, labels(v.stats), static_cast<double>((v.stats->*field).load(std::memory_order_relaxed)));
+        }
+    };
+    m.family("casino_viewer_attached", "gauge", "1 while the viewer shows a live server segment.");
+    for (const auto& v : views) m.sample("casino_viewer_attached", labels(v.stats), v.stats->attached.load());
+    counter("casino_viewer_frames_total", "Frames rendered.", &casino::ViewerStats::frames);
+    m.family("casino_viewer_frame_seconds", "summary", "Time between two viewer frames.");
+    for (const auto& v : views) m.summary("casino_viewer_frame_seconds", labels(v.stats), v.stats->frameTime);
+    counter("casino_viewer_seqlock_reads_total", "Snapshots copied through the seqlock.",
+            &casino::ViewerStats::seqlockReads);
+    counter("casino_viewer_seqlock_retries_total", "Seqlock retries of the viewer.", &casino::ViewerStats::seqlockRetries);
+    counter("casino_viewer_slow_reads_total", "Snapshots that needed more than SLOW_READ_RETRIES retries.",
+            &casino::ViewerStats::slowReads);
+    counter("casino_viewer_events_read_total", "Spin events consumed.", &casino::ViewerStats::eventsRead);
+    counter("casino_viewer_events_lost_total", "Spin events overwritten before the viewer read them.",
+            &casino::ViewerStats::eventsLost);
+    counter("casino_viewer_traced_spins_total", "Bet-started spins traced from the send to the screen.",
+            &casino::ViewerStats::tracedSpins);
+    m.family("casino_viewer_bet_to_pixel_seconds", "summary",
+             "Bet-to-pixel latency of traced spins by stage (queue, wakeup, roll, lock, poll, present) and total.");
+    for (const auto& v : views) {
+        for (int stage = 0; stage < casino::TRACE_STAGES; ++stage) {
+            m.summary("casino_viewer_bet_to_pixel_seconds",
+                      labels(v.stats) + ",stage=\"" + casino::trace_stage_name(stage) + "\"", v.stats->trace[stage]);
+        }
+    }
+    casino::viewer_stats_close_all(views);
+}
+
+std::string scrape() {
+    Metrics m;
+    std::vector<TableScrape> tables = open_tables();
+    table_metrics(m, tables);
+    for (auto& t : tables) casino::close_shared_memory(t.shm);
+    viewer_metrics(m);
+    g_scrapes++;
+    m.family("casino_exporter_scrapes_total", "counter", "Scrapes served by this exporter.");
+    m.sample("casino_exporter_scrapes_total", "", static_cast<double>(g_scrapes));
+    m.family("casino_exporter_read_retries_total", "counter", "Seqlock retries of the exporter.");
+    m.sample("casino_exporter_read_retries_total", "", static_cast<double>(g_readRetries));
+    m.family("casino_exporter_read_failures_total", "counter", "Tables skipped: no stable seqlock read.");
+    m.sample("casino_exporter_read_failures_total", "", static_cast<double>(g_readFailures));
+    return m.out;
+}
+
+bool write_all(int fd, const std::string& data) {
+    size_t off = 0;
+    while (off < data.size()) {
+        ssize_t n = write(fd, data.data() + off, data.size() - off);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        off += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// One request per connection: GET /metrics (or /) gets a scrape, anything else a 404.
+void serve_client(int fd) {
+    // the exporter serves one client at a time: a peer that stops reading (or
+    // never sends) must not stall the next scrapes past these timeouts
+    timeval timeout{2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    std::string request;
+    char buf[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0) break;
+        request.append(buf, static_cast<size_t>(n));
+    }
+    std::string line = request.substr(0, request.find("\r\n"));
+    bool metrics = line.rfind("GET /metrics ", 0) == 0 || line.rfind("GET / ", 0) == 0;
+    std::string body = metrics ? scrape() : "not found\n";
+    std::string head = metrics ? "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                               : "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\n";
+    head += "Content-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n";
+    if (write_all(fd, head)) write_all(fd, body);
+    close(fd);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string listenSpec = DEFAULT_LISTEN;
+    std::string unixPath;
+    bool once = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--listen" && i + 1 < argc) {
+            listenSpec = argv[++i];
+        } else if (arg == "--unix" && i + 1 < argc) {
+            unixPath = argv[++i];
+        } else if (arg == "--once") {
+            once = true;
+        } else {
+            std::fprintf(stderr, "Usage: casino_exporter [--listen [addr:]port | --unix PATH] [--once]\n");
+            return 1;
+        }
+    }
+    if (once) {
+        std::fputs(scrape().c_str(), stdout);
+        return 0;
+    }
+
+    int listenFd = unixPath.empty() ? casino::listen_tcp(listenSpec, "exporter") : casino::listen_unix(unixPath, "exporter");
+    if (listenFd < 0) return 1;
+    struct sigaction sa{};
+    sa.sa_handler = on_signal; // no SA_RESTART: poll returns on SIGINT/SIGTERM
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+    std::fprintf(stderr, "[exporter] serving /metrics on %s\n", unixPath.empty() ? listenSpec.c_str() : unixPath.c_str());
+
+    while (!g_stop) {
+        pollfd pfd{listenFd, POLLIN, 0};
+        if (poll(&pfd, 1, -1) <= 0) continue;
+        int client = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client >= 0) serve_client(client);
+    }
+    close(listenFd);
+    if (!unixPath.empty()) unlink(unixPath.c_str());
+    return 0;
+}
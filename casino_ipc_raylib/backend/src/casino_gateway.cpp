@@ -0,0 +1,572 @@
+// Network front end of the bet channel: many clients on TCP or a Unix socket
+// speak the binary protocol of gateway_protocol.hpp, and the gateway forwards
+// their bets to the tables in batches and pushes back the spins of the players
+// they bet for.
+//
+//   casino_gateway [--listen [addr:]port] [--unix PATH] [--max-conns N] [--poll-ms MS]
+//
+// One thread, one edge-triggered epoll loop. Each loop reads every readable
+// connection until EAGAIN, queues the decoded bets per table, forwards each
+// table's queue with send_bets (frames of BET_FRAME_MAX) and acks what it read.
+// Results come from the tables' event rings, tailed with an EventCursor every
+// --poll-ms while some connection waits for spins. A connection costs a fixed
+// input buffer; its output buffer is allocated once results flow to it and is
+// bounded too (what does not fit is dropped and counted).
+#include "ipc_shared.hpp"
+#include "bet_ring.hpp"
+#include "event_ring.hpp"
+#include "gateway_protocol.hpp"
+#include "net_listen.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void on_signal(int) { g_stop = 1; }
+
+constexpr const char* DEFAULT_LISTEN = "127.0.0.1:9470";
+constexpr size_t INPUT_BYTES = 512;   // > largest client message
+constexpr size_t OUTPUT_BYTES = 4096; // acks and results not yet written
+constexpr size_t FLUSH_BETS = 256;    // queued bets that force a forward mid-loop
+constexpr uint64_t TAG_TCP = ~0ull;   // epoll data of the listeners
+constexpr uint64_t TAG_UNIX = ~0ull - 1;
+constexpr size_t BET_MESSAGE_MAX = sizeof(casino::GatewayHeader) + casino::GATEWAY_BETS_MAX * sizeof(casino::GatewayBet);
+static_assert(BET_MESSAGE_MAX <= INPUT_BYTES, "a bet message must fit in the input buffer");
+
+struct Conn {
+    int fd = -1;
+    uint32_t gen = 1;          // bumped on close: stale epoll events and owners are ignored
+    uint32_t inLen = 0;
+    uint32_t outOff = 0;       // written so far
+    uint32_t outLen = 0;
+    int32_t resultAt = -1;     // offset of a GW_RESULT header still open for more records
+    uint32_t ackForwarded = 0; // since the last GW_ACK
+    uint32_t ackRefused = 0;
+    bool ackDue = false;
+    bool bettor = false;       // has bet: keeps the event rings polled
+    std::unique_ptr<char[]> out;
+    char in[INPUT_BYTES];
+};
+
+// Connection that bet last for a player: where its spins go.
+struct Owner {
+    uint32_t slot = 0;
+    uint32_t gen = 0; // 0: nobody
+};
+
+struct Table {
+    casino::SharedHandle shm{};
+    casino::BetSender sender{};
+    casino::EventCursor events{};
+    int seats = 0;
+    std::vector<casino::BetEntry> queue;
+    std::vector<uint64_t> queueConn; // slot | gen << 32 of each queued bet
+};
+
+struct GatewayStats {
+    uint64_t accepted = 0;  // connections
+    uint64_t rejected = 0;  // over --max-conns
+    uint64_t closed = 0;
+    uint64_t peak = 0;
+    uint64_t messages = 0;  // GW_BETS read
+    uint64_t badMessages = 0;
+    uint64_t betsForwarded = 0;
+    uint64_t betsRefused = 0;
+    uint64_t batches = 0;   // send_bets calls (one or more bet frames each)
+    uint64_t results = 0;   // GatewayResult records queued
+    uint64_t dropped = 0;   // acks and results that did not fit an output buffer
+};
+
+struct Gateway {
+    int epfd = -1;
+    int tcpFd = -1;
+    int unixFd = -1;
+    size_t maxConns = 16384;
+    size_t open = 0;
+    size_t bettors = 0;
+    bool acceptStalled = false; // out of fds: retry accepting after the next close
+    std::vector<Conn> conns;
+    std::vector<uint32_t> freeSlots;
+    std::vector<Table> tables;
+    std::vector<Owner> owners; // by global player id
+    std::vector<uint32_t> acks; // connections owed a GW_ACK this loop
+    std::vector<uint32_t> dirty; // connections given results by the current poll
+    GatewayStats stats;
+};
+
+uint64_t conn_key(uint32_t slot, uint32_t gen) { return static_cast<uint64_t>(gen) << 32 | slot; }
+
+void close_conn(Gateway& gw, uint32_t slot) {
+    Conn& c = gw.conns[slot];
+    if (c.fd < 0) return;
+    close(c.fd);
+    if (c.bettor) gw.bettors--;
+    c.fd = -1;
+    c.gen++;
+    c.inLen = c.outOff = c.outLen = 0;
+    c.resultAt = -1;
+    c.ackForwarded = c.ackRefused = 0;
+    c.ackDue = c.bettor = false;
+    c.out.reset();
+    gw.freeSlots.push_back(slot);
+    gw.open--;
+    gw.stats.closed++;
+}
+
+// Room for `bytes` more output, compacting or allocating the buffer as needed.
+bool reserve_output(Gateway& gw, Conn& c, size_t bytes) {
+    if (!c.out) c.out.reset(new char[OUTPUT_BYTES]);
+    if (c.outLen + bytes > OUTPUT_BYTES && c.outOff > 0) {
+        std::memmove(c.out.get(), c.out.get() + c.outOff, c.outLen - c.outOff);
+        c.outLen -= c.outOff;
+        c.resultAt = c.resultAt >= static_cast<int32_t>(c.outOff) ? c.resultAt - static_cast<int32_t>(c.outOff) : -1;
+        c.outOff = 0;
+    }
+    if (c.outLen + bytes <= OUTPUT_BYTES) return true;
+    gw.stats.dropped++;
+    return false;
+}
+
+void append_message(Gateway& gw, Conn& c, casino::GatewayType type, uint16_t count, const void* body, size_t bytes) {
+    if (!reserve_output(gw, c, sizeof(casino::GatewayHeader) + bytes)) return;
+    casino::GatewayHeader h{};
+    h.type = type;
+    h.count = count;
+    std::memcpy(c.out.get() + c.outLen, &h, sizeof(h));
+    if (bytes > 0) std::memcpy(c.out.get() + c.outLen + sizeof(h), body, bytes);
+    c.outLen += static_cast<uint32_t>(sizeof(h) + bytes);
+    c.resultAt = -1;
+}
+
+// Results of consecutive spins share one GW_RESULT message until it is full
+// or its header starts going out.
+void append_result(Gateway& gw, Conn& c, const casino::GatewayResult& r) {
+    if (c.resultAt >= static_cast<int32_t>(c.outOff)) {
+        auto* h = reinterpret_cast<casino::GatewayHeader*>(c.out.get() + c.resultAt);
+        if (h->count < casino::GATEWAY_RESULTS_MAX && c.outLen + sizeof(r) <= OUTPUT_BYTES) {
+            std::memcpy(c.out.get() + c.outLen, &r, sizeof(r));
+            c.outLen += sizeof(r);
+            h->count++;
+            gw.stats.results++;
+            return;
+        }
+    }
+    if (!reserve_output(gw, c, sizeof(casino::GatewayHeader) + sizeof(r))) return;
+    int32_t at = static_cast<int32_t>(c.outLen);
+    append_message(gw, c, casino::GW_RESULT, 1, &r, sizeof(r));
+    c.resultAt = at;
+    gw.stats.results++;
+}
+
+// Writes until done or EAGAIN (EPOLLOUT resumes). Returns false if the connection was closed.
+bool flush_output(Gateway& gw, uint32_t slot) {
+    Conn& c = gw.conns[slot];
+    while (c.outOff < c.outLen) {
+        ssize_t n = send(c.fd, c.out.get() + c.outOff, c.outLen - c.outOff, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        if (n <= 0) {
+            close_conn(gw, slot);
+            return false;
+        }
+        c.outOff += static_cast<uint32_t>(n);
+    }
+    c.outOff = c.outLen = 0;
+    c.resultAt = -1;
+    return true;
+}
+
+void protocol_error(Gateway& gw, uint32_t slot, casino::GatewayError error) {
+    gw.stats.badMessages++;
+    append_message(gw, gw.conns[slot], casino::GW_ERROR, error, nullptr, 0);
+    if (flush_output(gw, slot)) close_conn(gw, slot);
+}
+
+void owe_ack(Gateway& gw, uint32_t slot) {
+    Conn& c = gw.conns[slot];
+    if (!c.ackDue) {
+        c.ackDue = true;
+        gw.acks.push_back(slot);
+    }
+}
+
+void route_results(Gateway& gw);
+
+// Hands every queued bet to its table; the refused tail of a queue (channel
+// full) is reported in the acks.
+void forward_bets(Gateway& gw) {
+    const uint32_t tableCount = static_cast<uint32_t>(gw.tables.size());
+    bool queued = false;
+    for (const Table& table : gw.tables) queued = queued || !table.queue.empty();
+    if (!queued) return;
+    // Spins published before these bets are not their results. With no bettor
+    // the cursors stopped following the rings: skip the backlog. Otherwise
+    // route it to the current owners before the owners change below (queued
+    // only: we may be inside parse_input, flushing could close its connection).
+    if (gw.bettors == 0) {
+        for (Table& table : gw.tables) table.events = casino::event_cursor_at_head(casino::event_ring_of(table.shm.state));
+    } else {
+        route_results(gw);
+    }
+    for (uint32_t t = 0; t < tableCount; ++t) {
+        Table& table = gw.tables[t];
+        if (table.queue.empty()) continue;
+        size_t sent = casino::send_bets(table.sender, table.queue.data(), table.queue.size());
+        gw.stats.batches++;
+        for (size_t i = 0; i < table.queue.size(); ++i) {
+            uint32_t slot = static_cast<uint32_t>(table.queueConn[i]);
+            uint32_t gen = static_cast<uint32_t>(table.queueConn[i] >> 32);
+            bool ok = i < sent;
+            (ok ? gw.stats.betsForwarded : gw.stats.betsRefused)++;
+            Conn& c = gw.conns[slot];
+            if (c.gen != gen || c.fd < 0) continue;
+            if (ok) {
+                c.ackForwarded++;
+                uint32_t id = static_cast<uint32_t>(table.queue[i].playerId) * tableCount + t;
+                gw.owners[id] = Owner{slot, gen};
+                if (!c.bettor) {
+                    c.bettor = true;
+                    gw.bettors++;
+                }
+            } else {
+                c.ackRefused++;
+            }
+            owe_ack(gw, slot);
+        }
+        table.queue.clear();
+        table.queueConn.clear();
+    }
+}
+
+void send_acks(Gateway& gw) {
+    for (uint32_t slot : gw.acks) {
+        Conn& c = gw.conns[slot];
+        if (c.fd < 0 || !c.ackDue) continue;
+        casino::GatewayAck ack{c.ackForwarded, c.ackRefused};
+        c.ackForwarded = c.ackRefused = 0;
+        c.ackDue = false;
+        append_message(gw, c, casino::GW_ACK, 1, &ack, sizeof(ack));
+        flush_output(gw, slot);
+    }
+    gw.acks.clear();
+}
+
+// Decodes the complete messages of the input buffer. Returns false if the
+// connection was closed on a protocol error.
+bool parse_input(Gateway& gw, uint32_t slot) {
+    Conn& c = gw.conns[slot];
+    const int tableCount = static_cast<int>(gw.tables.size());
+    size_t at = 0;
+    while (c.inLen - at >= sizeof(casino::GatewayHeader)) {
+        casino::GatewayHeader h{};
+        std::memcpy(&h, c.in + at, sizeof(h));
+        if (h.version != casino::GATEWAY_PROTOCOL_VERSION) {
+            protocol_error(gw, slot, casino::GW_ERR_VERSION);
+            return false;
+        }
+        if (h.type != casino::GW_BETS) {
+            protocol_error(gw, slot, casino::GW_ERR_TYPE);
+            return false;
+        }
+        if (h.count == 0 || h.count > casino::GATEWAY_BETS_MAX) {
+            protocol_error(gw, slot, casino::GW_ERR_COUNT);
+            return false;
+        }
+        size_t bytes = sizeof(h) + h.count * sizeof(casino::GatewayBet);
+        if (c.inLen - at < bytes) break;
+        gw.stats.messages++;
+        for (int i = 0; i < h.count; ++i) {
+            casino::GatewayBet bet{};
+            std::memcpy(&bet, c.in + at + sizeof(h) + i * sizeof(bet), sizeof(bet));
+            int table = bet.playerId >= 0 ? casino::table_of_player(bet.playerId, tableCount) : 0;
+            int seat = bet.playerId >= 0 ? casino::seat_of_player(bet.playerId, tableCount) : -1;
+            if (seat < 0 || seat >= gw.tables[table].seats || bet.spins < 0) {
+                // the server would drop it as invalid: refuse it here, with no result to wait for
+                gw.stats.betsRefused++;
+                c.ackRefused++;
+                owe_ack(gw, slot);
+                continue;
+            }
+            casino::BetEntry entry{};
+            entry.playerId = seat;
+            entry.amount = bet.amount;
+            entry.spins = bet.spins;
+            gw.tables[table].queue.push_back(entry);
+            gw.tables[table].queueConn.push_back(conn_key(slot, c.gen));
+            if (gw.tables[table].queue.size() >= FLUSH_BETS) forward_bets(gw);
+        }
+        at += bytes;
+    }
+    if (at > 0) {
+        std::memmove(c.in, c.in + at, c.inLen - at);
+        c.inLen -= static_cast<uint32_t>(at);
+    }
+    return true;
+}
+
+// Edge-triggered: read until EAGAIN, decoding as the buffer fills.
+void read_conn(Gateway& gw, uint32_t slot) {
+    while (true) {
+        Conn& c = gw.conns[slot];
+        ssize_t n = read(c.fd, c.in + c.inLen, INPUT_BYTES - c.inLen);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        if (n <= 0) {
+            close_conn(gw, slot);
+            return;
+        }
+        c.inLen += static_cast<uint32_t>(n);
+        if (!parse_input(gw, slot)) return;
+    }
+}
+
+void accept_conns(Gateway& gw, int listenFd) {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno == EMFILE || errno == ENFILE) {
+                if (!gw.acceptStalled) std::fprintf(stderr, "[gateway] out of file descriptors: %s\n", std::strerror(errno));
+                gw.acceptStalled = true;
+            }
+            return;
+        }
+        if (gw.open >= gw.maxConns) {
+            gw.stats.rejected++;
+            close(fd);
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // fails harmlessly on Unix sockets
+        uint32_t slot = 0;
+        if (!gw.freeSlots.empty()) {
+            slot = gw.freeSlots.back();
+            gw.freeSlots.pop_back();
+        } else {
+            slot = static_cast<uint32_t>(gw.conns.size());
+            gw.conns.emplace_back();
+        }
+        Conn& c = gw.conns[slot];
+        c.fd = fd;
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.u64 = conn_key(slot, c.gen);
+        if (epoll_ctl(gw.epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            gw.open++;
+            close_conn(gw, slot);
+            continue;
+        }
+        gw.open++;
+        gw.stats.accepted++;
+        gw.stats.peak = std::max<uint64_t>(gw.stats.peak, gw.open);
+    }
+}
+
+// Queues the spins published since the last poll for the connections that bet
+// for those players; the connections given results are listed in gw.dirty.
+void route_results(Gateway& gw) {
+    casino::SpinEvent chunk[64];
+    for (uint32_t t = 0; t < gw.tables.size(); ++t) {
+        Table& table = gw.tables[t];
+        size_t n = 0;
+        while ((n = casino::event_ring_read(casino::event_ring_of(table.shm.state), table.events, chunk, 64)) > 0) {
+            for (size_t i = 0; i < n; ++i) {
+                const casino::SpinEvent& ev = chunk[i];
+                if (ev.playerId < 0 || static_cast<size_t>(ev.playerId) >= gw.owners.size()) continue;
+                const Owner& owner = gw.owners[ev.playerId];
+                Conn& c = gw.conns[owner.slot];
+                if (owner.gen == 0 || c.gen != owner.gen || c.fd < 0) continue;
+                casino::GatewayResult r{};
+                r.playerId = ev.playerId;
+                r.delta = ev.delta;
+                r.payout = ev.payout;
+                std::copy(ev.symbols, ev.symbols + 3, r.symbols);
+                r.table = t;
+                r.tick = ev.tick;
+                if (c.outLen == c.outOff) gw.dirty.push_back(owner.slot);
+                append_result(gw, c, r);
+            }
+        }
+    }
+}
+
+// Routes pending spins and sends them.
+void poll_results(Gateway& gw) {
+    route_results(gw);
+    for (uint32_t slot : gw.dirty) {
+        if (gw.conns[slot].fd >= 0) flush_output(gw, slot);
+    }
+    gw.dirty.clear();
+}
+
+bool raise_fd_limit(size_t wanted) {
+    rlimit lim{};
+    if (getrlimit(RLIMIT_NOFILE, &lim) != 0) return false;
+    if (lim.rlim_cur >= wanted) return true;
+    lim.rlim_cur = std::min<rlim_t>(lim.rlim_max, wanted);
+    setrlimit(RLIMIT_NOFILE, &lim);
+    return getrlimit(RLIMIT_NOFILE, &lim) == 0 && lim.rlim_cur >= wanted;
+}
+
+bool attach_tables(Gateway& gw) {
+    auto first = casino::open_shared_memory(false);
+    if (!first) {
+        std::fprintf(stderr, "[gateway] no server segment (start casino_server first)\n");
+        return false;
+    }
+    const int tableCount = static_cast<int>(std::max(1u, first->state->header.tableCount));
+    gw.tables.resize(tableCount);
+    gw.tables[0].shm = *first;
+    int maxSeats = 0;
+    for (int t = 0; t < tableCount; ++t) {
+        Table& table = gw.tables[t];
+        if (t > 0) {
+            auto h = casino::open_shared_memory(false, {}, t);
+            if (!h) {
+                std::fprintf(stderr, "[gateway] table %d not available\n", t);
+                return false;
+            }
+            table.shm = *h;
+        }
+        auto sender = casino::open_bet_sender(table.shm.state, t);
+        if (!sender) return false;
+        table.sender = *sender;
+        table.events = casino::event_cursor_at_head(casino::event_ring_of(table.shm.state));
+        casino::read_consistent(table.shm.state, [&]() { table.seats = table.shm.state->playerCount; });
+        maxSeats = std::max(maxSeats, table.seats);
+    }
+    gw.owners.assign(static_cast<size_t>(maxSeats) * tableCount, Owner{});
+    return true;
+}
+
+void usage() {
+    std::fprintf(stderr, "Usage: casino_gateway [--listen [addr:]port] [--unix PATH] [--max-conns N] [--poll-ms MS]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string listenSpec;
+    std::string unixPath;
+    int pollMs = 5;
+    Gateway gw;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--listen" && i + 1 < argc) {
+            listenSpec = argv[++i];
+        } else if (arg == "--unix" && i + 1 < argc) {
+            unixPath = argv[++i];
+        } else if (arg == "--max-conns" && i + 1 < argc) {
+            gw.maxConns = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--poll-ms" && i + 1 < argc) {
+            pollMs = std::max(1, std::atoi(argv[++i]));
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (listenSpec.empty() && unixPath.empty()) listenSpec = DEFAULT_LISTEN;
+    if (!raise_fd_limit(gw.maxConns + 64)) {
+        std::fprintf(stderr, "[gateway] RLIMIT_NOFILE below --max-conns %zu: accepts may fail early\n", gw.maxConns);
+    }
+    if (!attach_tables(gw)) {
+        for (auto& table : gw.tables) {
+            if (table.shm.state) casino::close_shared_memory(table.shm);
+        }
+        return 1;
+    }
+
+    gw.epfd = epoll_create1(EPOLL_CLOEXEC);
+    const int backlog = static_cast<int>(std::min<size_t>(gw.maxConns, 4096));
+    if (!listenSpec.empty()) gw.tcpFd = casino::listen_tcp(listenSpec, "gateway", backlog, true);
+    if (!unixPath.empty()) gw.unixFd = casino::listen_unix(unixPath, "gateway", backlog, true);
+    if (gw.epfd < 0 || (!listenSpec.empty() && gw.tcpFd < 0) || (!unixPath.empty() && gw.unixFd < 0)) return 1;
+    for (int fd : {gw.tcpFd, gw.unixFd}) {
+        if (fd < 0) continue;
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.u64 = fd == gw.tcpFd ? TAG_TCP : TAG_UNIX;
+        epoll_ctl(gw.epfd, EPOLL_CTL_ADD, fd, &ev);
+    }
+    struct sigaction sa{};
+    sa.sa_handler = on_signal; // no SA_RESTART: epoll_wait returns on SIGINT/SIGTERM
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+    std::fprintf(stderr, "[gateway] %zu table(s), listening on %s%s%s (max %zu connections)\n", gw.tables.size(),
+                 listenSpec.c_str(), listenSpec.empty() || unixPath.empty() ? "" : " and ", unixPath.c_str(), gw.maxConns);
+
+    std::vector<epoll_event> events(256);
+    while (!g_stop) {
+        // idle connections cost nothing; the rings are only polled for bettors
+        int n = epoll_wait(gw.epfd, events.data(), static_cast<int>(events.size()), gw.bettors > 0 ? pollMs : -1);
+        if (n < 0 && errno != EINTR) {
+            std::perror("[gateway] epoll_wait");
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            const uint64_t key = events[i].data.u64;
+            if (key == TAG_TCP || key == TAG_UNIX) {
+                accept_conns(gw, key == TAG_TCP ? gw.tcpFd : gw.unixFd);
+                continue;
+            }
+            const uint32_t slot = static_cast<uint32_t>(key);
+            if (slot >= gw.conns.size() || gw.conns[slot].gen != static_cast<uint32_t>(key >> 32)) continue;
+            if (gw.conns[slot].fd >= 0 && (events[i].events & EPOLLOUT) && !flush_output(gw, slot)) continue;
+            if (gw.conns[slot].fd >= 0 && (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) {
+                read_conn(gw, slot);
+            }
+        }
+        forward_bets(gw);
+        send_acks(gw);
+        if (gw.acceptStalled && gw.open < gw.maxConns) {
+            gw.acceptStalled = false;
+            if (gw.tcpFd >= 0) accept_conns(gw, gw.tcpFd);
+            if (gw.unixFd >= 0) accept_conns(gw, gw.unixFd);
+        }
+        poll_results(gw);
+    }
+
+    uint64_t lost = 0;
+    for (const auto& table : gw.tables) lost += table.events.lost;
+    std::printf("[gateway] connections: %llu accepted, %llu rejected, %llu closed, peak %llu\n",
+                static_cast<unsigned long long>(gw.stats.accepted), static_cast<unsigned long long>(gw.stats.rejected),
+                static_cast<unsigned long long>(gw.stats.closed), static_cast<unsigned long long>(gw.stats.peak));
+    std::printf("[gateway] bets: %llu messages, %llu forwarded in %llu batches, %llu refused, %llu bad messages\n",
+                static_cast<unsigned long long>(gw.stats.messages), static_cast<unsigned long long>(gw.stats.betsForwarded),
+                static_cast<unsigned long long>(gw.stats.batches), static_cast<unsigned long long>(gw.stats.betsRefused),
+                static_cast<unsigned long long>(gw.stats.badMessages));
+    std::printf("[gateway] results: %llu pushed, %llu dropped (output full), %llu events lost\n",
+                static_cast<unsigned long long>(gw.stats.results), static_cast<unsigned long long>(gw.stats.dropped),
+                static_cast<unsigned long long>(lost));
+
+    for (uint32_t slot = 0; slot < gw.conns.size(); ++slot) close_conn(gw, slot);
+    if (gw.tcpFd >= 0) close(gw.tcpFd);
+    if (gw.unixFd >= 0) {
+        close(gw.unixFd);
+        unlink(unixPath.c_str());
+    }
+    close(gw.epfd);
+    for (auto& table : gw.tables) {
+        casino::close_bet_sender(table.sender);
+        casino::close_shared_memory(table.shm);
+    }
+    return 0;
+}
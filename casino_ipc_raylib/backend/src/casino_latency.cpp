@@ -0,0 +1,182 @@
+// Live bet latency percentiles of a running casino_server, read from the
+// segment's histograms without locking or pausing the server.
+//
+//   casino_latency [--table t] [--seat s | --locks | --trace] [--interval ms] [--on-change]
+//
+// Without --interval, prints one report and exits; with it, refreshes until
+// SIGINT. --on-change refreshes only when the table publishes something,
+// sleeping on the segment's change futex meanwhile (at most one report per
+// --interval). --seat shows that seat's histograms instead of the table aggregate;
+// --locks shows mutex wait/hold times per lock site (casino_server --lock-profile);
+// --trace shows the bet-to-pixel stages each running viewer of the table measured.
+#include "ipc_shared.hpp"
+#include "latency_hist.hpp"
+#include "lock_profile.hpp"
+#include "viewer_stats.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <thread>
+
+namespace {
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void on_signal(int) { g_stop = 1; }
+
+const char* const STAGE_NAMES[casino::LAT_STAGES] = {"queue", "process", "total"};
+const char* const VERDICT_NAMES[casino::BET_VERDICTS] = {"accepted", "cooldown", "invalid"};
+
+void print_row(const char* verdict, const char* stage, const casino::LatencySummary& s) {
+    auto us = [](double ns) { return ns / 1000.0; };
+    std::printf("%-9s %-8s %12llu %10.1f %10.1f %10.1f %10.1f %10.1f\n", verdict, stage,
+                static_cast<unsigned long long>(s.count), us(static_cast<double>(s.p50Ns)),
+                us(static_cast<double>(s.p99Ns)), us(static_cast<double>(s.p999Ns)), us(static_cast<double>(s.maxNs)),
+                us(s.meanNs));
+}
+
+void report(const casino::SharedState* state, int table, int seat) {
+    const casino::LatencyHistogram* block = casino::latency_block_of(state);
+    if (seat < 0) {
+        std::printf("table %d, all seats (us)\n", table);
+    } else {
+        std::printf("table %d, seat %d (us)\n", table, seat);
+    }
+    std::printf("%-9s %-8s %12s %10s %10s %10s %10s %10s\n", "verdict", "stage", "bets", "p50", "p99", "p999", "max",
+                "mean");
+    const int verdicts = seat < 0 ? casino::BET_VERDICTS : casino::SEAT_VERDICTS;
+    for (int v = 0; v < verdicts; ++v) {
+        for (int stage = 0; stage < casino::LAT_STAGES; ++stage) {
+            size_t index = seat < 0 ? casino::latency_index(stage, v) : casino::latency_seat_index(seat, stage, v);
+            print_row(VERDICT_NAMES[v], STAGE_NAMES[stage], casino::latency_summarize(block[index]));
+        }
+    }
+    std::fflush(stdout);
+}
+
+void report_locks(const casino::SharedState* state, int table) {
+    const casino::LockSiteProfile* profiles = casino::lock_profile_of(state);
+    auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+    std::printf("table %d, mutex by site (us)\n", table);
+    std::printf("%-7s %-14s %10s %9s %9s %9s %9s %9s %9s %9s\n", "role", "site", "acquired", "wait50", "wait99",
+                "wait999", "hold50", "hold99", "hold999", "holdmax");
+    for (int site = 0; site < casino::LOCK_SITES; ++site) {
+        casino::LatencySummary wait = casino::latency_summarize(profiles[site].wait);
+        casino::LatencySummary hold = casino::latency_summarize(profiles[site].hold);
+        std::printf("%-7s %-14s %10llu %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f\n", casino::lock_site_role(site),
+                    casino::lock_site_name(site), static_cast<unsigned long long>(wait.count), us(wait.p50Ns),
+                    us(wait.p99Ns), us(wait.p999Ns), us(hold.p50Ns), us(hold.p99Ns), us(hold.p999Ns), us(hold.maxNs));
+    }
+    std::fflush(stdout);
+}
+
+// Read from the viewers' own stats segments: works without the server too.
+void report_trace(int table) {
+    std::vector<casino::ViewerStatsView> views = casino::viewer_stats_open_all();
+    int shown = 0;
+    for (const auto& v : views) {
+        if (v.stats->table != table) continue;
+        shown++;
+        std::printf("table %d, viewer pid %d: bet to pixel, %llu traced spins (us)\n", table, v.stats->pid,
+                    static_cast<unsigned long long>(v.stats->tracedSpins.load(std::memory_order_relaxed)));
+        std::printf("%-9s %-8s %12s %10s %10s %10s %10s %10s\n", "", "stage", "spins", "p50", "p99", "p999", "max",
+                    "mean");
+        for (int stage = 0; stage < casino::TRACE_STAGES; ++stage) {
+            print_row("", casino::trace_stage_name(stage), casino::latency_summarize(v.stats->trace[stage]));
+        }
+    }
+    if (shown == 0) std::printf("table %d: no running viewer\n", table);
+    casino::viewer_stats_close_all(views);
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int table = 0;
+    int seat = -1;
+    int intervalMs = 0;
+    bool locks = false;
+    bool trace = false;
+    bool onChange = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--table" && i + 1 < argc) {
+            table = std::clamp(std::atoi(argv[++i]), 0, casino::MAX_TABLES - 1);
+        } else if (arg == "--seat" && i + 1 < argc) {
+            seat = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--locks") {
+            locks = true;
+        } else if (arg == "--trace") {
+            trace = true;
+        } else if (arg == "--interval" && i + 1 < argc) {
+            intervalMs = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--on-change") {
+            onChange = true;
+        } else {
+            std::fprintf(stderr, "Usage: casino_latency [--table t] [--seat s | --locks | --trace] [--interval ms] "
+                                 "[--on-change]\n");
+            return 1;
+        }
+    }
+    if (onChange && trace) {
+        std::fprintf(stderr, "[latency] --on-change follows a table segment, not the viewers (--trace)\n");
+        return 1;
+    }
+
+    std::optional<casino::SharedHandle> shm;
+    if (!trace) {
+        shm = casino::open_shared_memory(false, {}, table);
+        if (!shm) {
+            std::fprintf(stderr, "[latency] table %d not available (casino_server running?)\n", table);
+            return 1;
+        }
+        if (seat >= 0 && static_cast<uint32_t>(seat) >= shm->state->header.capacity) {
+            std::fprintf(stderr, "[latency] seat %d outside table capacity %u\n", seat, shm->state->header.capacity);
+            casino::close_shared_memory(*shm);
+            return 1;
+        }
+        if (locks && !shm->state->header.lockProfile) {
+            std::fprintf(stderr, "[latency] table %d is not profiling its mutex (start casino_server --lock-profile)\n",
+                         table);
+            casino::close_shared_memory(*shm);
+            return 1;
+        }
+    }
+    auto show = [&] {
+        if (trace) {
+            report_trace(table);
+        } else if (locks) {
+            report_locks(shm->state, table);
+        } else {
+            report(shm->state, table, seat);
+        }
+    };
+
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+    show();
+    uint32_t seen = onChange ? shm->state->generation.load(std::memory_order_acquire) : 0;
+    while ((intervalMs > 0 || onChange) && !g_stop) {
+        if (onChange) {
+            // short timeout: a restarted futex wait would not notice SIGINT
+            uint32_t generation = casino::wait_state_change(shm->state, seen, 500);
+            if (generation == seen) continue;
+            seen = generation;
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+        }
+        if (g_stop) break;
+        std::printf("\n");
+        show();
+        std::fflush(stdout);
+        if (onChange && intervalMs > 0) std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+    }
+    if (shm) casino::close_shared_memory(*shm);
+    return 0;
+}
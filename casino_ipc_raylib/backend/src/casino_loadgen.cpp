@@ -0,0 +1,490 @@
+// Open-loop load generator: thousands of simulated players driven by a few
+// sender threads, instead of one `player` process per seat. Bets leave on a
+// schedule (constant, Poisson or bursty arrivals at a target rate, with a
+// linear ramp or a staircase of stages) whether or not the server keeps up,
+// so the reports show where it saturates.
+//
+//   casino_loadgen [--players N] [--threads T] [--rate R] [--duration S]
+//                  [--arrival constant|poisson|bursty] [--burst B] [--ramp S]
+//                  [--steps R1:S1,R2:S2,...] [--frame N] [--report-ms MS] [--seed S]
+#include "ipc_shared.hpp"
+#include "bet_ring.hpp"
+#include "latency_hist.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fcntl.h>
+#include <mqueue.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+enum class Arrival { Constant, Poisson, Bursty };
+
+// One stage of the schedule: `rate` bets/s for `seconds`.
+struct Stage {
+    double rate = 0.0;
+    double seconds = 0.0;
+};
+
+struct LoadOptions {
+    int players = 0;          // simulated players (0: every seat of the server)
+    int threads = 2;
+    double rate = 1000.0;     // target bets/s across all threads
+    double duration = 10.0;   // seconds, when --steps is not given
+    Arrival arrival = Arrival::Poisson;
+    int burst = 32;           // bets per burst (bursty arrivals)
+    double ramp = 0.0;        // seconds of linear ramp-up at the start of each stage
+    std::vector<Stage> steps; // staircase; overrides --rate/--duration
+    int frame = 1;            // bets per frame, at most (bets due together share a frame)
+    int reportMs = 1000;
+    uint64_t seed = 1;
+};
+
+// Per-thread counters, read by the reporter; one cache line per sender.
+struct alignas(64) SenderStats {
+    std::atomic<uint64_t> sent{0};     // accepted by the bet channel
+    std::atomic<uint64_t> rejected{0}; // ring full / MQ full (channel back-pressure)
+    std::atomic<int64_t> lagNs{0};     // how far behind schedule the last send was
+};
+
+// Segment of one table, as seen by the generator.
+struct TableLink {
+    casino::SharedHandle shm{};
+    casino::BetTransport transport = casino::BET_TRANSPORT_RING;
+    mqd_t mq = static_cast<mqd_t>(-1); // MQ mode: for the depth column
+    int seats = 0;
+};
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void on_signal(int) { g_stop = 1; }
+
+int64_t mono_ns() {
+    struct timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+void sleep_until_ns(int64_t t) {
+    struct timespec ts{};
+    ts.tv_sec = static_cast<time_t>(t / 1000000000LL);
+    ts.tv_nsec = static_cast<long>(t % 1000000000LL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR && !g_stop) {
+    }
+}
+
+bool parse_steps(const std::string& spec, std::vector<Stage>& out) {
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        size_t colon = item.find(':');
+        if (colon == std::string::npos) return false;
+        Stage s{std::atof(item.substr(0, colon).c_str()), std::atof(item.substr(colon + 1).c_str())};
+        if (s.rate <= 0.0 || s.seconds <= 0.0) return false;
+        out.push_back(s);
+    }
+    return !out.empty();
+}
+
+// Target rate of the whole generator at `t` seconds into the run.
+double rate_at(const LoadOptions& opt, double t, int* stageOut = nullptr) {
+    double begin = 0.0;
+    for (size_t i = 0; i < opt.steps.size(); ++i) {
+        const Stage& s = opt.steps[i];
+        if (t < begin + s.seconds || i + 1 == opt.steps.size()) {
+            if (stageOut) *stageOut = static_cast<int>(i);
+            double into = t - begin;
+            double scale = opt.ramp > 0.0 ? std::clamp(into / opt.ramp, 0.01, 1.0) : 1.0;
+            return s.rate * scale;
+        }
+        begin += s.seconds;
+    }
+    return 0.0;
+}
+
+double total_seconds(const LoadOptions& opt) {
+    double t = 0.0;
+    for (const auto& s : opt.steps) t += s.seconds;
+    return t;
+}
+
+// Sender `index`: owns players index, index + T, ... and 1/T of the rate.
+// Sends the bets queued for one table, as frames of up to --frame bets.
+void flush_bets(const LoadOptions& opt, casino::BetSender& sender, std::vector<casino::BetEntry>& queued,
+                SenderStats& stats) {
+    for (size_t at = 0; at < queued.size(); at += static_cast<size_t>(opt.frame)) {
+        size_t n = std::min(queued.size() - at, static_cast<size_t>(opt.frame));
+        size_t sent = casino::send_bets(sender, queued.data() + at, n);
+        stats.sent.fetch_add(sent, std::memory_order_relaxed);
+        stats.rejected.fetch_add(n - sent, std::memory_order_relaxed);
+    }
+    queued.clear();
+}
+
+// Arrivals are scheduled on absolute times from the arrival process; a sender
+// that falls behind sends immediately (open loop) and reports its lag. Bets
+// due together (a burst, or arrivals the thread is late for) share frames;
+// nothing is held while the thread sleeps. Each thread has its own senders,
+// hence its own frame sequences.
+void run_sender(const LoadOptions& opt, int index, int64_t startNs, std::vector<casino::BetSender>& senders,
+                int serverPlayers, SenderStats& stats) {
+    std::mt19937_64 rng(opt.seed * 0x9E3779B97F4A7C15ull + static_cast<uint64_t>(index));
+    std::uniform_int_distribution<int> betDist(10, 120);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const double share = 1.0 / opt.threads;
+    const int tableCount = static_cast<int>(senders.size());
+    const double endT = total_seconds(opt);
+    int nextPlayer = index;
+    std::vector<std::vector<casino::BetEntry>> queued(tableCount);
+    auto flush_all = [&]() {
+        for (int t = 0; t < tableCount; ++t) {
+            if (!queued[t].empty()) flush_bets(opt, senders[t], queued[t], stats);
+        }
+    };
+
+    double t = 0.0; // seconds since start of the next arrival
+    while (!g_stop) {
+        double rate = rate_at(opt, t) * share;
+        if (rate <= 0.0) break;
+        int batch = 1;
+        double gap = 0.0;
+        switch (opt.arrival) {
+        case Arrival::Constant:
+            gap = 1.0 / rate;
+            break;
+        case Arrival::Poisson:
+            gap = -std::log(1.0 - unit(rng)) / rate;
+            break;
+        case Arrival::Bursty:
+            // compound Poisson: bursts of `burst` back-to-back bets at rate / burst
+            batch = opt.burst;
+            gap = -std::log(1.0 - unit(rng)) * opt.burst / rate;
+            break;
+        }
+        t += gap;
+        if (t >= endT) break;
+        int64_t due = startNs + static_cast<int64_t>(t * 1e9);
+        int64_t now = mono_ns();
+        if (due > now) {
+            flush_all();
+            sleep_until_ns(due);
+            now = mono_ns();
+        }
+        stats.lagNs.store(now - due, std::memory_order_relaxed);
+        for (int b = 0; b < batch; ++b) {
+            // simulated player -> global id -> (table, seat), as `player` routes
+            int id = nextPlayer % serverPlayers;
+            nextPlayer += opt.threads;
+            if (nextPlayer >= opt.players) nextPlayer = index;
+            const int table = casino::table_of_player(id, tableCount);
+            casino::BetEntry bet{};
+            bet.playerId = casino::seat_of_player(id, tableCount);
+            bet.amount = betDist(rng);
+            queued[table].push_back(bet);
+            if (static_cast<int>(queued[table].size()) >= opt.frame) flush_bets(opt, senders[table], queued[table], stats);
+        }
+    }
+    flush_all();
+}
+
+// Server-side view across tables: spins applied, bets drained by verdict (from
+// the latency histograms), what became of the cooldown ones, and frames still
+// queued.
+struct ServerCounters {
+    uint64_t rounds = 0;
+    uint64_t verdicts[casino::BET_VERDICTS] = {};
+    uint64_t deferred = 0;  // cooldown bets held, spun when the cooldown ended
+    uint64_t coalesced = 0; // cooldown bets folded into an already held one
+    uint64_t expired = 0;   // held bets dropped after --bet-ttl-ms
+    int64_t depth = 0;      // a gauge: not subtracted by since()
+
+    // Bets the server turned away: they will never start a spin of their own.
+    uint64_t refused() const { return verdicts[casino::BET_INVALID] + coalesced + expired; }
+};
+
+ServerCounters since(const ServerCounters& now, const ServerCounters& then) {
+    ServerCounters d = now;
+    d.rounds -= then.rounds;
+    for (int v = 0; v < casino::BET_VERDICTS; ++v) d.verdicts[v] -= then.verdicts[v];
+    d.deferred -= then.deferred;
+    d.coalesced -= then.coalesced;
+    d.expired -= then.expired;
+    return d;
+}
+
+ServerCounters read_server(const std::vector<TableLink>& tables) {
+    ServerCounters c{};
+    for (const auto& link : tables) {
+        const casino::SharedState* st = link.shm.state;
+        int32_t rounds = 0;
+        uint64_t deferred = 0, coalesced = 0, expired = 0;
+        casino::read_consistent(st, [&]() {
+            rounds = st->rounds;
+            deferred = st->bet_deferred;
+            coalesced = st->bet_coalesced;
+            expired = st->bet_expired;
+        });
+        c.rounds += static_cast<uint64_t>(std::max(0, rounds));
+        c.deferred += deferred;
+        c.coalesced += coalesced;
+        c.expired += expired;
+        const casino::LatencyHistogram* block = casino::latency_block_of(st);
+        for (int v = 0; v < casino::BET_VERDICTS; ++v) {
+            c.verdicts[v] += block[casino::latency_index(casino::LAT_TOTAL, v)].count.load(std::memory_order_relaxed);
+        }
+        if (link.transport == casino::BET_TRANSPORT_RING) {
+            c.depth += static_cast<int64_t>(casino::bet_ring_depth(casino::bet_ring_of(st)));
+        } else {
+            struct mq_attr attr{};
+            if (mq_getattr(link.mq, &attr) == 0) c.depth += attr.mq_curmsgs;
+        }
+    }
+    return c;
+}
+
+void usage() {
+    std::fprintf(stderr,
+                 "Usage: casino_loadgen [--players N] [--threads T] [--rate R] [--duration S]\n"
+                 "                      [--arrival constant|poisson|bursty] [--burst B] [--ramp S]\n"
+                 "                      [--steps R1:S1,R2:S2,...] [--frame N] [--report-ms MS] [--seed S]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    LoadOptions opt{};
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--players" && i + 1 < argc) {
+            opt.players = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            opt.threads = std::clamp(std::atoi(argv[++i]), 1, 256);
+        } else if (arg == "--rate" && i + 1 < argc) {
+            opt.rate = std::max(1.0, std::atof(argv[++i]));
+        } else if (arg == "--duration" && i + 1 < argc) {
+            opt.duration = std::max(0.1, std::atof(argv[++i]));
+        } else if (arg == "--arrival" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "constant") {
+                opt.arrival = Arrival::Constant;
+            } else if (mode == "poisson") {
+                opt.arrival = Arrival::Poisson;
+            } else if (mode == "bursty") {
+                opt.arrival = Arrival::Bursty;
+            } else {
+                usage();
+                return 1;
+            }
+        } else if (arg == "--burst" && i + 1 < argc) {
+            opt.burst = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--ramp" && i + 1 < argc) {
+            opt.ramp = std::max(0.0, std::atof(argv[++i]));
+        } else if (arg == "--steps" && i + 1 < argc) {
+            if (!parse_steps(argv[++i], opt.steps)) {
+                std::fprintf(stderr, "[loadgen] bad --steps (expected rate:seconds,...)\n");
+                return 1;
+            }
+        } else if (arg == "--frame" && i + 1 < argc) {
+            opt.frame = std::clamp(std::atoi(argv[++i]), 1, casino::BET_FRAME_MAX);
+        } else if (arg == "--report-ms" && i + 1 < argc) {
+            opt.reportMs = std::max(50, std::atoi(argv[++i]));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            opt.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (opt.steps.empty()) opt.steps.push_back(Stage{opt.rate, opt.duration});
+
+    // Table 0 tells how many tables the server runs; attach to all of them
+    auto first = casino::open_shared_memory(false);
+    if (!first) {
+        std::fprintf(stderr, "[loadgen] no server segment (start casino_server first)\n");
+        return 1;
+    }
+    const int tableCount = static_cast<int>(std::max(1u, first->state->header.tableCount));
+    std::vector<TableLink> tables(tableCount);
+    tables[0].shm = *first;
+    int serverPlayers = 0;
+    for (int t = 0; t < tableCount; ++t) {
+        if (t > 0) {
+            auto h = casino::open_shared_memory(false, {}, t);
+            if (!h) {
+                std::fprintf(stderr, "[loadgen] table %d not available\n", t);
+                for (int j = 0; j < t; ++j) casino::close_shared_memory(tables[j].shm);
+                return 1;
+            }
+            tables[t].shm = *h;
+        }
+        tables[t].transport = static_cast<casino::BetTransport>(tables[t].shm.state->header.betTransport);
+        if (tables[t].transport == casino::BET_TRANSPORT_MQ) {
+            tables[t].mq = mq_open(casino::table_mq_name(t).c_str(), O_RDONLY | O_NONBLOCK);
+        }
+        int32_t seats = 0;
+        casino::read_consistent(tables[t].shm.state, [&]() { seats = tables[t].shm.state->playerCount; });
+        tables[t].seats = seats;
+        serverPlayers += seats;
+    }
+    if (serverPlayers <= 0) {
+        std::fprintf(stderr, "[loadgen] server has no seats yet\n");
+        return 1;
+    }
+    if (opt.players == 0) opt.players = serverPlayers;
+    opt.threads = std::min(opt.threads, opt.players);
+
+    // one sender per thread and table: each keeps its own frame sequence
+    std::vector<std::vector<casino::BetSender>> threadSenders(opt.threads);
+    for (int k = 0; k < opt.threads; ++k) {
+        for (int t = 0; t < tableCount; ++t) {
+            auto sender = casino::open_bet_sender(tables[t].shm.state, t, static_cast<uint32_t>(getpid()) * 256u + k);
+            if (!sender) {
+                for (auto& link : tables) casino::close_shared_memory(link.shm);
+                return 1;
+            }
+            if (sender->transport == casino::BET_TRANSPORT_MQ) {
+                // a full queue is back-pressure to count, not a reason to block the schedule
+                struct mq_attr attr{};
+                attr.mq_flags = O_NONBLOCK;
+                mq_setattr(sender->mq, &attr, nullptr);
+            }
+            threadSenders[k].push_back(*sender);
+        }
+    }
+
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    const bool ring = tables[0].transport == casino::BET_TRANSPORT_RING;
+    std::printf("[loadgen] %d simulated players over %d seats / %d table(s), %d sender thread(s), %s arrivals, bets=%s, "
+                "frames of <= %d\n",
+                opt.players, serverPlayers, tableCount, opt.threads,
+                opt.arrival == Arrival::Constant ? "constant" : opt.arrival == Arrival::Poisson ? "poisson" : "bursty",
+                ring ? "ring" : "mq", opt.frame);
+    // full: refused by the bet channel. accept/cool/inval: drained, by server
+    // verdict. held/coal/expir: what became of the cooldown ones. reject%:
+    // channel refusals plus bets the server turned away (invalid, coalesced,
+    // expired), over the bets offered.
+    std::printf("%8s %10s %10s %9s %9s %9s %9s %9s %9s %9s %8s %9s %8s %9s\n", "t(s)", "target/s", "sent/s", "full/s",
+                "accept/s", "cool/s", "inval/s", "held/s", "coal/s", "expir/s", "reject%", "spins/s", "depth",
+                "lag(ms)");
+
+    std::vector<SenderStats> stats(opt.threads);
+    std::vector<std::thread> senders;
+    const int64_t startNs = mono_ns();
+    for (int k = 0; k < opt.threads; ++k) {
+        senders.emplace_back(run_sender, std::cref(opt), k, startNs, std::ref(threadSenders[k]), serverPlayers,
+                             std::ref(stats[k]));
+    }
+
+    // Reporter: one line per interval, one summary per stage
+    struct Totals {
+        uint64_t sent = 0;
+        uint64_t rejected = 0;
+    };
+    auto totals = [&]() {
+        Totals t{};
+        for (const auto& s : stats) {
+            t.sent += s.sent.load(std::memory_order_relaxed);
+            t.rejected += s.rejected.load(std::memory_order_relaxed);
+        }
+        return t;
+    };
+    const double endT = total_seconds(opt);
+    Totals prev{};
+    ServerCounters prevServer = read_server(tables);
+    const ServerCounters firstServer = prevServer;
+    int64_t prevNs = startNs;
+    int stage = 0;
+    Totals stageStart{};
+    ServerCounters stageServer = prevServer;
+    int64_t stageNs = startNs;
+    // the server settles a bet a little after it was sent: clamp the interval skew
+    auto reject_pct = [](uint64_t sent, uint64_t full, const ServerCounters& d) {
+        double offered = static_cast<double>(sent + full);
+        return offered > 0 ? std::min(100.0, 100.0 * static_cast<double>(full + d.refused()) / offered) : 0.0;
+    };
+    auto stage_summary = [&](int index, const Totals& now, const ServerCounters& server, int64_t ns) {
+        double secs = std::max(1e-9, (ns - stageNs) / 1e9);
+        uint64_t sent = now.sent - stageStart.sent;
+        uint64_t rejected = now.rejected - stageStart.rejected;
+        ServerCounters d = since(server, stageServer);
+        std::printf("[stage %d] target %.0f/s: sent %.0f/s, rejected %.2f%% (channel full %.0f/s, invalid %.0f/s, "
+                    "coalesced %.0f/s, expired %.0f/s), accepted %.0f/s, cooldown %.0f/s, spins %.0f/s\n",
+                    index, opt.steps[index].rate, sent / secs, reject_pct(sent, rejected, d), rejected / secs,
+                    d.verdicts[casino::BET_INVALID] / secs, d.coalesced / secs, d.expired / secs,
+                    d.verdicts[casino::BET_ACCEPTED] / secs, d.verdicts[casino::BET_COOLDOWN] / secs, d.rounds / secs);
+        stageStart = now;
+        stageServer = server;
+        stageNs = ns;
+    };
+
+    int64_t nextReport = startNs + static_cast<int64_t>(opt.reportMs) * 1000000LL;
+    while (!g_stop) {
+        sleep_until_ns(nextReport);
+        int64_t now = mono_ns();
+        nextReport += static_cast<int64_t>(opt.reportMs) * 1000000LL;
+        double t = (now - startNs) / 1e9;
+        double secs = std::max(1e-9, (now - prevNs) / 1e9);
+        Totals cur = totals();
+        ServerCounters server = read_server(tables);
+        uint64_t sent = cur.sent - prev.sent;
+        uint64_t rejected = cur.rejected - prev.rejected;
+        ServerCounters d = since(server, prevServer);
+        int64_t lag = 0;
+        for (const auto& s : stats) lag = std::max(lag, s.lagNs.load(std::memory_order_relaxed));
+        int current = 0;
+        rate_at(opt, std::min(t, endT), &current);
+        double target = rate_at(opt, std::min(t - secs / 2, endT)); // mid-interval, not the stage about to start
+        std::printf("%8.1f %10.0f %10.0f %9.0f %9.0f %9.0f %9.0f %9.0f %9.0f %9.0f %7.2f%% %9.0f %8lld %9.2f\n", t,
+                    target, sent / secs, rejected / secs, d.verdicts[casino::BET_ACCEPTED] / secs,
+                    d.verdicts[casino::BET_COOLDOWN] / secs, d.verdicts[casino::BET_INVALID] / secs,
+                    d.deferred / secs, d.coalesced / secs, d.expired / secs, reject_pct(sent, rejected, d),
+                    d.rounds / secs, static_cast<long long>(server.depth), lag / 1e6);
+        std::fflush(stdout);
+        if (current != stage || t >= endT) {
+            stage_summary(stage, cur, server, now);
+            stage = current;
+        }
+        prev = cur;
+        prevServer = server;
+        prevNs = now;
+        if (t >= endT) break;
+    }
+    g_stop = 1;
+    for (auto& s : senders) s.join();
+
+    Totals all = totals();
+    ServerCounters server = read_server(tables);
+    double secs = std::max(1e-9, (mono_ns() - startNs) / 1e9);
+    double offered = static_cast<double>(all.sent + all.rejected);
+    ServerCounters d = since(server, firstServer);
+    std::printf("[loadgen] %.1f s: offered %.0f/s, sent %.0f/s, rejected %llu (%.2f%%: channel full %llu, invalid %llu, "
+                "coalesced %llu, expired %llu), server spins %llu\n",
+                secs, offered / secs, all.sent / secs, static_cast<unsigned long long>(all.rejected + d.refused()),
+                reject_pct(all.sent, all.rejected, d), static_cast<unsigned long long>(all.rejected),
+                static_cast<unsigned long long>(d.verdicts[casino::BET_INVALID]),
+                static_cast<unsigned long long>(d.coalesced), static_cast<unsigned long long>(d.expired),
+                static_cast<unsigned long long>(d.rounds));
+
+    for (auto& senders : threadSenders) {
+        for (auto& sender : senders) casino::close_bet_sender(sender);
+    }
+    for (auto& link : tables) {
+        if (link.mq != static_cast<mqd_t>(-1)) mq_close(link.mq);
+        casino::close_shared_memory(link.shm);
+    }
+    return 0;
+}
@@ -1,4 +1,11 @@
 #include "ipc_shared.hpp"
+#include "bet_ring.hpp"
+#include "event_ring.hpp"
+#include "latency_hist.hpp"
+#include "lock_profile.hpp"
+#include "slot_math.hpp"
+#include "journal.hpp"
+#include "table_engine.hpp"
 #include <chrono>
 #include <csignal>
 #include <cstdlib>
@@ -9,292 +16,1144 @@
 #include <random>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <algorithm>
 #include <cstring>
 #include <fstream>
+#include <functional>
+#include <queue>
+#include <sstream>
 #include <vector>
-#include <semaphore.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
 
 using namespace std::chrono_literals;
 
 namespace {
-volatile std::sig_atomic_t g_running = 1;
 
-void handle_sigint(int) { g_running = 0; }
+using casino::LoopStamps;
+using casino::SpinOutcome;
+using casino::TableEngine;
+using casino::TickSample;
 
-struct TargetPos {
-    float x = 0.0f;
-    float y = 0.0f;
-    std::chrono::steady_clock::time_point nextChange;
-};
+// Unpacks drained frames into bets, in order. Tracks each sender's sequence:
+// a jump counts the frames skipped, a repeat is dropped. A sender restarting
+// at 1 starts a new sequence. Counters continue those of the segment.
+struct BetDecoder {
+    std::unordered_map<uint32_t, uint32_t> lastSeq; // sender -> last frame taken
+    uint64_t frames = 0;
+    uint64_t gaps = 0;
+    uint64_t dups = 0;
+    uint64_t bad = 0;
+
+    void resume(const casino::SharedState* s) {
+        frames = s->bet_frames;
+        gaps = s->bet_seq_gaps;
+        dups = s->bet_seq_dups;
+        bad = s->bet_bad_frames;
+    }
 
-constexpr int SPIN_COST = 20;
-constexpr int SYMBOL_COUNT = 4;
+    void decode(const casino::BetFrame& f, std::vector<casino::BetMessage>& out) {
+        frames++;
+        if (f.version < casino::BET_PROTOCOL_VERSION || f.version > casino::BET_PROTOCOL_VERSION ||
+            f.count == 0 || f.count > casino::BET_FRAME_MAX) {
+            bad++;
+            return;
+        }
+        auto [it, fresh] = lastSeq.try_emplace(f.sender, 0);
+        const int32_t step = static_cast<int32_t>(f.seq - it->second);
+        if (!fresh && step <= 0 && f.seq != 1) {
+            dups++;
+            return;
+        }
+        if (!fresh && step > 1) gaps += static_cast<uint64_t>(step - 1);
+        it->second = f.seq;
+        for (int i = 0; i < f.count; ++i) {
+            const casino::BetEntry& b = f.bets[i];
+            out.push_back(casino::BetMessage{b.playerId, b.amount, f.sentNs, b.spins, f.sender, f.seq, i});
+        }
+    }
 
-struct SpinTimers {
-    std::chrono::steady_clock::time_point nextAllowed;
-    float cooldownMin = 2.0f;
-    float cooldownMax = 5.0f;
-    std::chrono::steady_clock::time_point nextRandomStart;
+    void publish(TickSample& sample) const {
+        sample.betFrames = frames;
+        sample.betSeqGaps = gaps;
+        sample.betSeqDups = dups;
+        sample.betBadFrames = bad;
+    }
 };
 
-static bool load_layout(const std::string& path, std::vector<TargetPos>& out, int playerCount) {
-    std::ifstream f(path);
-    if (!f.is_open()) return false;
-    int idx = 0;
-    std::string tag;
-    while (f >> tag) {
-        if (tag == "P") {
-            float x, y;
-            if (!(f >> x >> y)) break;
-            if (idx < playerCount && idx < (int)out.size()) {
-                out[idx].x = x;
-                out[idx].y = y;
+// Bridges ring futex wakeups into the epoll loop. The thread parks on the ring
+// futex (producers only wake it when it is parked), rings an eventfd, then waits
+// for the loop to acknowledge the drain before parking again.
+struct RingDoorbell {
+    casino::BetRing* ring = nullptr;
+    int evfd = -1;
+    std::atomic<uint32_t> drained{0};
+    std::atomic<bool> stop{false};
+    std::thread worker;
+
+    bool start(casino::BetRing* r) {
+        ring = r;
+        evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (evfd < 0) return false;
+        worker = std::thread([this]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                casino::bet_ring_wait(ring, -1, &stop);
+                uint32_t seen = drained.load(std::memory_order_acquire);
+                // after sampling `drained`: shutdown bumps it only after setting stop
+                if (stop.load(std::memory_order_relaxed)) break;
+                uint64_t one = 1;
+                if (write(evfd, &one, sizeof(one)) < 0) { /* counter saturated: loop is awake anyway */ }
+                casino::futex_wait(&drained, seen, -1);
             }
-            idx++;
-        } else if (tag == "S") {
-            // skip scale line
-            std::string rest;
-            std::getline(f, rest);
-        }
+        });
+        return true;
     }
-    return true;
+
+    // Called by the loop after draining the ring.
+    void ack() {
+        uint64_t v = 0;
+        if (read(evfd, &v, sizeof(v)) < 0) { /* EAGAIN: nothing pending */ }
+        drained.fetch_add(1, std::memory_order_release);
+        casino::futex_wake(&drained, 1);
+    }
+
+    void shutdown() {
+        if (!worker.joinable()) return;
+        stop.store(true, std::memory_order_relaxed);
+        casino::bet_ring_kick(ring);
+        drained.fetch_add(1, std::memory_order_release);
+        casino::futex_wake(&drained, 1);
+        worker.join();
+        close(evfd);
+    }
+};
+
+// Arms the loop timer one-shot at the next deadline, or disarms it (sleep until a bet).
+void arm_timer(int tfd, std::chrono::steady_clock::time_point deadline) {
+    struct itimerspec its{};
+    int flags = 0;
+    if (deadline != std::chrono::steady_clock::time_point::max()) {
+        // steady_clock is CLOCK_MONOTONIC on Linux, like the timerfd
+        int64_t ns = std::max<int64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count(), 1);
+        its.it_value.tv_sec = static_cast<time_t>(ns / 1000000000);
+        its.it_value.tv_nsec = static_cast<long>(ns % 1000000000);
+        flags = TFD_TIMER_ABSTIME;
+    }
+    timerfd_settime(tfd, flags, &its, nullptr);
 }
 
-} // namespace
+// Command line, shared by every table.
+struct ServerOptions {
+    int playerCount = 6;   // total across tables
+    int tables = 1;
+    unsigned int seed = 0;
+    casino::SegmentConfig segCfg{};
+    casino::BetTransport transport = casino::BET_TRANSPORT_RING;
+    bool randomStarts = true;
+    std::string journalPath; // --journal: one file per table (".t<t>" suffix for t > 0)
+    int betTtlMs = 5000;         // --bet-ttl-ms: a bet held through a cooldown expires after this (0: never)
+    int syncMs = 1000;           // --state-file: msync period of the file-backed segments
+    double virtualSeconds = 0.0; // --virtual-time: simulated horizon, 0 = real time
+    std::string betScript;       // --bet-script: bets of the virtual run (default: player cadence)
+    bool realtime = false;       // --realtime: busy-polling table loops on prefaulted, mlocked segments
+    std::vector<int> cpus;       // --cpus: table t runs on cpus[t % size] (default: core t)
+    int fifoPriority = 0;        // --fifo: SCHED_FIFO priority of the table loops (0: normal scheduling)
+    int spinUs = 500;            // --realtime: longest busy-poll for a bet before parking on the ring futex
+};
 
-int main(int argc, char** argv) {
-    int playerCount = 6;
-    unsigned int seed = static_cast<unsigned int>(std::random_device{}());
+// The table logic's share of the options.
+casino::EngineConfig engine_config(const ServerOptions& opt) {
+    casino::EngineConfig cfg;
+    cfg.seed = opt.seed;
+    cfg.tables = opt.tables;
+    cfg.randomStarts = opt.randomStarts;
+    cfg.betTtlMs = opt.betTtlMs;
+    cfg.transport = opt.transport;
+    return cfg;
+}
 
-    for (int i = 1; i < argc; ++i) {
-        std::string arg = argv[i];
-        if (arg == "--players" && i + 1 < argc) {
-            playerCount = std::atoi(argv[++i]);
-            if (playerCount < 1) playerCount = 1;
-            if (playerCount > casino::MAX_PLAYERS) playerCount = casino::MAX_PLAYERS;
-        } else if (arg == "--seed" && i + 1 < argc) {
-            seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
-        }
+// One table: its own segment (mutex, jackpot, bet ring), MQ, RNG and timers,
+// served by one worker thread. Tables share nothing at runtime.
+struct Table {
+    int index = 0;
+    int seats = 0;             // players routed here (ids with id % tables == index)
+    casino::SharedHandle shm{};
+    bool adopted = false;      // state taken over from the previous server (--state-file)
+    mqd_t mq = static_cast<mqd_t>(-1);
+    int stopFd = -1;           // eventfd: main thread asks the worker to exit
+    std::atomic<bool> stopping{false}; // same request for a --realtime loop (then woken by bet_ring_kick)
+    casino::JournalWriter journal{}; // open only with --journal
+    std::thread worker;
+};
+
+// Pins the calling thread to one core; threads it spawns afterwards inherit it.
+void pin_to_core(int core) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        std::cerr << "[server] could not pin to core " << core << "\n";
     }
+}
 
-    std::cout << "[server] starting with players=" << playerCount << " seed=" << seed << "\n";
-    std::signal(SIGINT, handle_sigint);
+// --fifo: real-time scheduling for the calling thread. Needs CAP_SYS_NICE or an
+// RLIMIT_RTPRIO of at least `priority`; the loop runs normally scheduled otherwise.
+void set_fifo(int priority, int table) {
+    struct sched_param sp{};
+    sp.sched_priority = priority;
+    int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+    if (rc != 0) {
+        std::cerr << "[server] table " << table << ": SCHED_FIFO " << priority << " refused: " << std::strerror(rc) << "\n";
+    }
+}
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// How late the loop's timer wakeups (animation tick or engine deadline) run
+// behind schedule, in either loop; the figure to compare --realtime against
+// the default epoll loop. Printed when the table stops.
+struct LoopJitter {
+    casino::LatencyHistogram late;
+    uint64_t spinHits = 0; // --realtime: iterations whose bets were caught busy-polling
+    uint64_t parks = 0;    // --realtime: futex sleeps on the ring
+
+    void record(std::chrono::steady_clock::time_point scheduled, std::chrono::steady_clock::time_point now) {
+        casino::latency_record(late, now > scheduled ? static_cast<uint64_t>((now - scheduled).count()) : 0);
+    }
 
-    auto handleOpt = casino::open_shared_memory(true);
+    void report(int table, bool spinning) const {
+        const casino::LatencySummary s = casino::latency_summarize(late);
+        auto us = [](double ns) { return ns / 1000.0; };
+        std::ostringstream line;
+        line.setf(std::ios::fixed);
+        line.precision(1);
+        line << "[server] table " << table << ": loop jitter over " << s.count << " timer wakeups (" << (spinning ? "busy-poll" : "epoll")
+             << "): p50 " << us(static_cast<double>(s.p50Ns)) << " us, p99 " << us(static_cast<double>(s.p99Ns)) << " us, p999 "
+             << us(static_cast<double>(s.p999Ns)) << " us, max " << us(static_cast<double>(s.maxNs)) << " us";
+        if (spinning) line << "; " << spinHits << " bet wakeups caught spinning, " << parks << " parks";
+        std::cout << line.str() << std::endl;
+    }
+};
+
+// --journal: one file per table, ".t<t>" suffix for t > 0.
+bool open_table_journal(casino::JournalWriter& journal, const ServerOptions& opt, int index, int seats) {
+    casino::JournalHeader meta{};
+    meta.seed = opt.seed;
+    meta.tableId = index;
+    meta.tableCount = opt.tables;
+    meta.seats = seats;
+    meta.randomStarts = opt.randomStarts ? 1 : 0;
+    meta.betTtlMs = opt.betTtlMs;
+    std::string path = index == 0 ? opt.journalPath : opt.journalPath + ".t" + std::to_string(index);
+    return casino::journal_create(journal, path, meta);
+}
+
+// Creates the segment and (MQ mode) message queue of one table.
+bool open_table(Table& t, const ServerOptions& opt) {
+    casino::SegmentConfig cfg = opt.segCfg;
+    cfg.capacity = static_cast<uint32_t>(t.seats);
+    cfg.tableId = static_cast<uint32_t>(t.index);
+    cfg.tableCount = static_cast<uint32_t>(opt.tables);
+    const auto started = std::chrono::steady_clock::now();
+    auto handleOpt = casino::open_shared_memory(true, cfg, t.index);
     if (!handleOpt) {
-        return 1;
+        return false;
     }
-    casino::SharedHandle shm = *handleOpt;
-    if (!casino::initialize_state(shm.state)) {
-        std::cerr << "[server] failed to init shared state\n";
-        casino::close_shared_memory(shm);
-        return 1;
+    t.shm = *handleOpt;
+    t.adopted = t.shm.adopted;
+    // --realtime: no page fault on the hot path, before the state is even initialised
+    if (opt.realtime) casino::prefault_mapping(t.shm.state, t.shm.size, t.shm.fd, true);
+    if (t.adopted) {
+        const bool wasClean = t.shm.state->header.clean.load(std::memory_order_acquire) != 0;
+        if (!casino::adopt_state(t.shm.state, cfg)) {
+            std::cerr << "[server] failed to adopt shared state of table " << t.index << "\n";
+            casino::close_shared_memory(t.shm);
+            return false;
+        }
+        std::cout << "[server] table " << t.index << ": adopted " << casino::state_file_path(t.index) << " (epoch "
+                  << t.shm.state->header.epoch.load() << ", " << (wasClean ? "clean shutdown" : "recovered after a crash")
+                  << ", jackpot " << t.shm.state->jackpot << ", rounds " << t.shm.state->rounds << ") in "
+                  << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count()
+                  << " ms\n";
+    } else if (!casino::initialize_state(t.shm.state, cfg)) {
+        std::cerr << "[server] failed to init shared state of table " << t.index << "\n";
+        casino::close_shared_memory(t.shm);
+        return false;
+    }
+    // the dirty flag must reach the file before the table starts changing it
+    if (!casino::sync_segment(t.shm, true)) {
+        std::cerr << "[server] msync of table " << t.index << " failed: " << std::strerror(errno) << "\n";
     }
 
-    sem_unlink(casino::SEM_NAME);
-    sem_t* sem = sem_open(casino::SEM_NAME, O_CREAT, 0666, 0);
-    bool semOk = sem != SEM_FAILED;
-    if (!semOk) {
-        std::cerr << "[server] sem_open failed, continuing without semaphore wakeup\n";
-    }
-
-    mq_unlink(casino::MQ_NAME);
-    struct mq_attr attr{};
-    attr.mq_maxmsg = 10; // stay within typical /proc/sys/fs/mqueue/msg_max default
-    attr.mq_msgsize = sizeof(casino::BetMessage);
-    attr.mq_flags = 0;
-    attr.mq_curmsgs = 0;
-    mqd_t mq = mq_open(casino::MQ_NAME, O_CREAT | O_RDONLY | O_NONBLOCK, 0666, &attr);
-    if (mq == static_cast<mqd_t>(-1)) {
-        std::cerr << "[server] mq_open failed: " << std::strerror(errno) << "\n";
-        std::cerr << "Hint: ensure /dev/mqueue is mounted (sudo mount -t mqueue none /dev/mqueue) or run scripts/clean_ipc.sh then retry.\n";
-        casino::close_shared_memory(shm);
-        return 1;
+    // MQ fallback: the message queue descriptor is polled directly by epoll
+    const std::string mqName = casino::table_mq_name(t.index);
+    mq_unlink(mqName.c_str());
+    if (opt.transport == casino::BET_TRANSPORT_MQ) {
+        struct mq_attr attr{};
+        attr.mq_maxmsg = 10; // stay within typical /proc/sys/fs/mqueue/msg_max default
+        attr.mq_msgsize = sizeof(casino::BetFrame);
+        attr.mq_flags = 0;
+        attr.mq_curmsgs = 0;
+        t.mq = mq_open(mqName.c_str(), O_CREAT | O_RDONLY | O_NONBLOCK, 0666, &attr);
+        if (t.mq == static_cast<mqd_t>(-1)) {
+            std::cerr << "[server] mq_open failed: " << std::strerror(errno) << "\n";
+            std::cerr << "Hint: ensure /dev/mqueue is mounted (sudo mount -t mqueue none /dev/mqueue) or run scripts/clean_ipc.sh then retry.\n";
+            casino::close_shared_memory(t.shm);
+            return false;
+        }
+    }
+    t.stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (t.stopFd < 0) {
+        if (t.mq != static_cast<mqd_t>(-1)) mq_close(t.mq);
+        casino::close_shared_memory(t.shm);
+        return false;
     }
+    if (!opt.journalPath.empty() && t.adopted) {
+        // a replay starts from a fresh table and could not reproduce the adopted state
+        std::cerr << "[server] table " << t.index << ": state adopted, not journaled\n";
+    } else if (!opt.journalPath.empty()) {
+        if (!open_table_journal(t.journal, opt, t.index, t.seats)) {
+            close(t.stopFd);
+            if (t.mq != static_cast<mqd_t>(-1)) mq_close(t.mq);
+            casino::close_shared_memory(t.shm);
+            return false;
+        }
+    }
+    return true;
+}
 
-    std::mt19937 rng(seed);
-    std::uniform_int_distribution<int> winChance(1, 100);
-
-    std::vector<TargetPos> targets(casino::MAX_PLAYERS);
-    const float cx = 960.0f;
-    const float cy = 540.0f + 60.0f;
-    const float radius = 300.0f;
-    for (int i = 0; i < playerCount; ++i) {
-        float angle = 3.14159f / 2 + (6.28318f * i / std::max(6, playerCount));
-        targets[i].x = cx + radius * std::cos(angle);
-        targets[i].y = cy + radius * std::sin(angle);
-    }
-    // Load layout.txt if present to override positions
-    if (!load_layout("viewer/layout.txt", targets, playerCount)) {
-        load_layout("layout.txt", targets, playerCount);
-    }
-
-    if (!casino::safe_mutex_lock(&shm.state->mutex)) {
-        std::cerr << "[server] failed to lock mutex during init\n";
-    }
-    shm.state->playerCount = playerCount;
-    shm.state->jackpot = 1200; // banque initiale: doubled from 600
-    for (int i = 0; i < playerCount; ++i) {
-        shm.state->players[i].id = i;
-        shm.state->players[i].x = targets[i].x;
-        shm.state->players[i].y = targets[i].y;
-        shm.state->players[i].animState = casino::ANIM_IDLE;
-        shm.state->players[i].pulse = 0.0f;
-        shm.state->players[i].pid = -1;
-    }
-    pthread_mutex_unlock(&shm.state->mutex);
-
-    auto lastPulseDecay = std::chrono::steady_clock::now();
-    const auto spinDuration = 2s;
-    std::vector<SpinTimers> timers(casino::MAX_PLAYERS);
-    auto nowInit = std::chrono::steady_clock::now();
-    constexpr float MIN_COOLDOWN = 2.2f;
-    std::uniform_int_distribution<int> initialJitter(0, 800);
-    std::uniform_int_distribution<int> randomStart(1000, 4000);
-    for (int i = 0; i < casino::MAX_PLAYERS; ++i) {
-        timers[i].nextAllowed = nowInit + std::chrono::milliseconds(200 * i + initialJitter(rng));
-        timers[i].cooldownMin = MIN_COOLDOWN + (i * 0.1f);
-        timers[i].cooldownMax = 4.5f + (i * 0.2f);
-        timers[i].nextRandomStart = nowInit + std::chrono::milliseconds(randomStart(rng));
-    }
-
-    // weights for symbols: 7 (rare), diamond, bell, strawberry (common)
-    int weights[SYMBOL_COUNT] = {1, 3, 5, 8};
-    int payouts[SYMBOL_COUNT] = {400, 220, 140, 90};
-
-    auto pick_symbol = [&]() {
-        int total = 0;
-        for (int w : weights) total += w;
-        std::uniform_int_distribution<int> dist(1, total);
-        int r = dist(rng);
-        int acc = 0;
-        for (int i = 0; i < SYMBOL_COUNT; ++i) {
-            acc += weights[i];
-            if (r <= acc) return i;
-        }
-        return SYMBOL_COUNT - 1;
-    };
+void close_table(Table& t) {
+    casino::journal_close(t.journal);
+    if (t.stopFd >= 0) close(t.stopFd);
+    if (t.mq != static_cast<mqd_t>(-1)) mq_close(t.mq);
+    casino::close_shared_memory(t.shm);
+}
 
-    auto run_spin = [&](int playerId) {
-        int symA = pick_symbol();
-        int symB = pick_symbol();
-        int symC = pick_symbol();
-        bool win = (symA == symB && symB == symC);
-        int payout = win ? payouts[symA] : 0;
-        int delta = payout - SPIN_COST;
-
-        if (!casino::safe_mutex_lock(&shm.state->mutex)) {
-            std::cerr << "[server] failed to lock mutex for spin\n";
-        }
-        shm.state->mutex_held = 1;
-        // record epoch ms when mutex was acquired
-        shm.state->mutex_last_held_ts = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
-        shm.state->tick++;
-        shm.state->rounds++;
-        shm.state->jackpot += delta;
-        if (shm.state->jackpot < 0) shm.state->jackpot = 0;
-        auto& p = shm.state->players[playerId];
-        p.symbols[0] = symA;
-        p.symbols[1] = symB;
-        p.symbols[2] = symC;
-        p.lastDelta = delta;
-        p.lastPayout = payout;
-        p.spinning = 1;
-        p.spinProgress = 0.0f;
-        p.animState = win ? casino::ANIM_WIN : casino::ANIM_LOSE;
-        p.pulse = win ? 1.0f : 0.3f;
-        shm.state->lastWinnerId = win ? playerId : -1;
-        shm.state->lastWinAmount = payout;
-        shm.state->mutex_held = 0;
-        pthread_mutex_unlock(&shm.state->mutex);
+// FNV-1a over the part of the segment the table logic determines: counters,
+// jackpot, batch stats and every seat except its position and pid. Spin stamps
+// count from `originNs` (the engine's start) so live runs and replays agree.
+// Wall-clock and bet-channel instrumentation are left out. Read without the
+// lock: only the table's own thread writes the segment.
+uint64_t state_digest(const casino::SharedState* s, uint64_t originNs) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    auto mix = [&h](const void* data, size_t n) {
+        const auto* b = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < n; ++i) {
+            h ^= b[i];
+            h *= 0x100000001B3ull;
+        }
     };
+    mix(&s->tick, sizeof(s->tick));
+    mix(&s->jackpot, sizeof(s->jackpot));
+    mix(&s->rounds, sizeof(s->rounds));
+    mix(&s->lastWinnerId, sizeof(s->lastWinnerId));
+    mix(&s->lastWinAmount, sizeof(s->lastWinAmount));
+    mix(&s->playerCount, sizeof(s->playerCount));
+    mix(&s->batch_commits, sizeof(s->batch_commits));
+    mix(&s->batch_max, sizeof(s->batch_max));
+    mix(s->batch_hist, sizeof(s->batch_hist));
+    casino::ConstPlayerArrays players = casino::players_of(s);
+    for (int i = 0; i < s->playerCount; ++i) {
+        const casino::PlayerSeat& p = players.seats[i];
+        mix(&p.id, sizeof(p.id));
+        mix(&p.animState, sizeof(p.animState));
+        mix(p.symbols, sizeof(p.symbols));
+        mix(&p.lastDelta, sizeof(p.lastDelta));
+        mix(&p.lastPayout, sizeof(p.lastPayout));
+        const uint64_t spinStart = players.spinStartNs[i] ? players.spinStartNs[i] - originNs : 0;
+        const uint64_t pulseStart = players.pulseStartNs[i] ? players.pulseStartNs[i] - originNs : 0;
+        mix(&spinStart, sizeof(spinStart));
+        mix(&pulseStart, sizeof(pulseStart));
+        mix(&players.pulsePeak[i], sizeof(float));
+    }
+    return h;
+}
 
-    while (g_running) {
-        // Attendre un signal léger (semaphore) ou timeout pour éviter le busy loop
-        if (semOk) {
-            struct timespec ts{};
-            auto nowWake = std::chrono::steady_clock::now() + 16ms;
-            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(nowWake.time_since_epoch()).count();
-            ts.tv_sec = static_cast<time_t>(ns / 1000000000);
-            ts.tv_nsec = static_cast<long>(ns % 1000000000);
-            sem_timedwait(sem, &ts); // ignore ETIMEDOUT/errors
-        } else {
-            std::this_thread::sleep_for(2ms);
-        }
-
-        casino::BetMessage msg{};
-        while (true) {
-            ssize_t r = mq_receive(mq, reinterpret_cast<char*>(&msg), sizeof(msg), nullptr);
-            if (r >= 0) {
-                int pid = msg.playerId % casino::MAX_PLAYERS;
-                auto now = std::chrono::steady_clock::now();
-                if (pid < 0 || pid >= playerCount) continue;
-                if (now >= timers[pid].nextAllowed) {
-                    float cd = std::uniform_real_distribution<float>(timers[pid].cooldownMin, timers[pid].cooldownMax)(rng);
-                    timers[pid].nextAllowed = now + std::chrono::milliseconds((int)(cd * 1000));
-                    run_spin(pid);
-                }
-            } else {
-                break;
+casino::JournalRecord spin_record(uint64_t t, const SpinOutcome& o, bool randomStart) {
+    casino::JournalRecord r{};
+    r.t = t;
+    r.type = casino::JOURNAL_SPIN;
+    r.seat = o.playerId;
+    r.a = o.symbols[0] | (o.symbols[1] << 8) | (o.symbols[2] << 16);
+    r.b = o.payout;
+    r.c = randomStart ? 1 : 0;
+    return r;
+}
+
+// Journals one loop iteration, after the commit has released the lock: the
+// bets it drained, the spins it rolled and the digest of what it published.
+void journal_step(casino::JournalWriter& j, uint64_t t, const std::vector<casino::BetMessage>& bets,
+                  bool timerFired, const TableEngine& engine, bool committed) {
+    casino::JournalRecord loop{};
+    loop.t = t;
+    loop.type = casino::JOURNAL_LOOP;
+    loop.a = timerFired ? 1 : 0;
+    loop.b = static_cast<int32_t>(bets.size());
+    if (!casino::journal_append(j, loop)) return;
+    for (const auto& msg : bets) {
+        casino::JournalRecord bet{};
+        bet.t = t;
+        bet.type = casino::JOURNAL_BET;
+        bet.seat = msg.playerId;
+        bet.a = msg.amount;
+        bet.b = msg.spins;
+        if (!casino::journal_append(j, bet)) return;
+    }
+    for (size_t i = 0; i < engine.batch.size(); ++i) {
+        if (!casino::journal_append(j, spin_record(t, engine.batch[i], i >= engine.betSpins))) return;
+    }
+    if (committed) {
+        casino::JournalRecord c{};
+        c.t = t;
+        c.type = casino::JOURNAL_COMMIT;
+        c.a = static_cast<int32_t>(engine.state->tick);
+        c.c = state_digest(engine.state, engine.originNs);
+        casino::journal_append(j, c);
+    }
+}
+
+// Files every bet of one loop iteration into the latency histograms: queued
+// from its send stamp to `drainedNs`, processed until `doneNs` (result
+// published, or verdict reached when nothing was committed). Runs after the
+// commit, outside the lock; this thread is the histograms' only writer.
+void record_latencies(casino::SharedState* state, const std::vector<casino::BetMessage>& bets,
+                      const std::vector<uint8_t>& verdicts, uint64_t drainedNs, uint64_t doneNs) {
+    casino::LatencyHistogram* block = casino::latency_block_of(state);
+    const uint64_t process = doneNs > drainedNs ? doneNs - drainedNs : 0;
+    for (size_t i = 0; i < bets.size() && i < verdicts.size(); ++i) {
+        const casino::BetMessage& msg = bets[i];
+        if (msg.sentNs == 0) continue; // unstamped sender
+        const int verdict = verdicts[i];
+        const uint64_t queue = drainedNs > msg.sentNs ? drainedNs - msg.sentNs : 0;
+        const uint64_t sample[casino::LAT_STAGES] = {queue, process, queue + process};
+        for (int stage = 0; stage < casino::LAT_STAGES; ++stage) {
+            casino::latency_record(block[casino::latency_index(stage, verdict)], sample[stage]);
+            if (verdict != casino::BET_INVALID) {
+                casino::latency_record(block[casino::latency_seat_index(msg.playerId, stage, verdict)], sample[stage]);
             }
         }
+    }
+}
+
+// Worker of one table: owns its engine, event loop and journal until asked to
+// stop. Default loop: epoll over the bet doorbell (or MQ), the timerfd and
+// stopFd. --realtime with the ring: busy-polls the ring and the clock, parking
+// on the ring futex only when a bet is not seen within an adaptive spin budget.
+void serve_table(Table& t, const ServerOptions& opt) {
+    const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    pin_to_core(opt.cpus.empty() ? t.index % cores : opt.cpus[static_cast<size_t>(t.index) % opt.cpus.size()]);
+    if (opt.fifoPriority > 0) set_fifo(opt.fifoPriority, t.index);
+    casino::SharedHandle& shm = t.shm;
+    mqd_t mq = t.mq;
+    const bool useMq = opt.transport == casino::BET_TRANSPORT_MQ;
+    const bool spinning = opt.realtime && !useMq;
+    if (opt.realtime && useMq) {
+        std::cerr << "[server] table " << t.index << ": busy-polling needs the bet ring, keeping the epoll loop\n";
+    }
+    casino::BetRing* ring = casino::bet_ring_of(shm.state);
+
+    // journal timestamps are ns since this point
+    const auto epoch = std::chrono::steady_clock::now();
+    TableEngine engine;
+    engine.init(shm.state, engine_config(opt), t.index, t.seats, epoch, t.adopted);
+
+    std::vector<casino::BetFrame> drainBuf(ring->slots);
+    std::vector<casino::BetMessage> pending;
+    pending.reserve(ring->slots);
+    BetDecoder decoder;
+    decoder.resume(shm.state);
+    LoopJitter jitter;
+    RingDoorbell doorbell; // epoll loop only
+    LoopStamps stamps;     // wakeNs set by the loops, idleNs at the end of each step
 
-        // Lancer des spins aléatoires même sans message, pour désynchroniser encore plus
-        auto nowRandom = std::chrono::steady_clock::now();
-        for (int pid = 0; pid < playerCount; ++pid) {
-            auto& t = timers[pid];
-            if (nowRandom >= t.nextRandomStart && nowRandom >= t.nextAllowed) {
-                float cd = std::uniform_real_distribution<float>(t.cooldownMin, t.cooldownMax)(rng);
-                t.nextAllowed = nowRandom + std::chrono::milliseconds((int)(cd * 1000));
-                t.nextRandomStart = nowRandom + std::chrono::milliseconds(randomStart(rng));
-                run_spin(pid);
+    // One iteration once the loop is awake: drain every pending bet in one
+    // pass, apply them in arrival order, publish and journal.
+    auto step = [&](bool timerFired, bool doorbellRang) {
+        pending.clear();
+        if (!useMq) {
+            size_t n = casino::bet_ring_drain(ring, drainBuf.data(), drainBuf.size());
+            while (n > 0) {
+                for (size_t f = 0; f < n; ++f) decoder.decode(drainBuf[f], pending);
+                n = casino::bet_ring_drain(ring, drainBuf.data(), drainBuf.size());
+            }
+            if (doorbellRang) doorbell.ack();
+        } else {
+            casino::BetFrame frame{};
+            while (mq_receive(mq, reinterpret_cast<char*>(&frame), sizeof(frame), nullptr) >= 0) {
+                decoder.decode(frame, pending);
             }
         }
 
+        // one timestamp per iteration: everything drained here arrived "now"
         auto now = std::chrono::steady_clock::now();
-        float dt = std::chrono::duration<float>(now - lastPulseDecay).count();
-        lastPulseDecay = now;
-
-        if (!casino::safe_mutex_lock(&shm.state->mutex)) {
-            std::cerr << "[server] failed to lock mutex for periodic update\n";
-        }
-        shm.state->mutex_held = 1;
-        shm.state->mutex_last_held_ts = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
-        shm.state->tick++;
-        for (int i = 0; i < shm.state->playerCount; ++i) {
-            auto& p = shm.state->players[i];
-            if (p.spinning) {
-                p.spinProgress += dt / std::chrono::duration<float>(spinDuration).count();
-                if (p.spinProgress >= 1.0f) {
-                    p.spinning = 0;
-                    p.spinProgress = 1.0f;
+        bool publish = engine.roll(now, pending, timerFired);
+        if (publish) {
+            TickSample sample{};
+            sample.wallMs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+            sample.betDepth = static_cast<int32_t>(casino::bet_ring_depth(ring));
+            if (useMq) {
+                struct mq_attr curAttr{};
+                sample.betDepth = mq_getattr(mq, &curAttr) == 0 ? static_cast<int32_t>(curAttr.mq_curmsgs) : 0;
+            }
+            sample.betOverflows = ring->overflows.load(std::memory_order_relaxed);
+            sample.betWakeups = ring->wakeups.load(std::memory_order_relaxed);
+            sample.betAbandoned = ring->abandoned.load(std::memory_order_relaxed);
+            decoder.publish(sample);
+            engine.commit(now, sample, &pending, stamps);
+        }
+        if (!pending.empty()) {
+            record_latencies(shm.state, pending, engine.verdicts,
+                             static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count()),
+                             casino::monotonic_ns());
+        }
+        // iterations without bets or a commit changed nothing and are not journaled
+        if (t.journal.header && (publish || !pending.empty())) {
+            journal_step(t.journal, static_cast<uint64_t>((now - epoch).count()), pending, timerFired, engine, publish);
+        }
+        stamps.idleNs = casino::monotonic_ns();
+    };
+    using Clock = std::chrono::steady_clock;
+
+    if (spinning) {
+        // Spin budget adapts to the traffic: doubled each time a bet shows up
+        // while spinning, halved each time the loop had to park.
+        const Clock::duration maxSpin = std::chrono::microseconds(opt.spinUs);
+        const Clock::duration minSpin = std::max<Clock::duration>(maxSpin / 16, std::chrono::microseconds(1));
+        const auto parkMargin = std::chrono::milliseconds(1); // futex timeouts are whole ms: spin the rest
+        Clock::duration budget = maxSpin;
+        while (!t.stopping.load(std::memory_order_relaxed)) {
+            auto now = Clock::now();
+            const auto wakeAt = engine.next_deadline();
+            const auto spinUntil = now + budget;
+            bool parked = false;
+            bool timerFired = false;
+            while (!casino::bet_ring_pending(ring) && !t.stopping.load(std::memory_order_relaxed)) {
+                now = Clock::now();
+                if (now >= wakeAt) {
+                    timerFired = true;
+                    break;
+                }
+                if (now >= spinUntil && (wakeAt == Clock::time_point::max() || wakeAt - now > 2 * parkMargin)) {
+                    int timeoutMs = wakeAt == Clock::time_point::max()
+                                        ? -1
+                                        : static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(wakeAt - now - parkMargin).count());
+                    casino::bet_ring_wait(ring, timeoutMs, &t.stopping);
+                    parked = true;
+                    jitter.parks++;
+                    continue;
                 }
+                cpu_relax();
             }
-            p.pulse = std::max(0.0f, p.pulse - 0.6f * dt);
+            if (t.stopping.load(std::memory_order_relaxed)) break;
+            if (timerFired) {
+                jitter.record(wakeAt, now);
+            } else if (!parked) {
+                jitter.spinHits++;
+            }
+            budget = parked ? std::max(minSpin, budget / 2) : std::min(maxSpin, budget * 2);
+            stamps.wakeNs = casino::monotonic_ns();
+            step(timerFired, false);
+        }
+        jitter.report(t.index, true);
+        return;
+    }
+
+    // Event sources: bets (ring doorbell eventfd, or the MQ descriptor), the
+    // deadline timerfd and SIGINT/SIGTERM. No fixed sleeps and no animation
+    // tick: with no pending deadline the loop blocks indefinitely.
+    int ep = epoll_create1(EPOLL_CLOEXEC);
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (ep < 0 || tfd < 0 || (!useMq && !doorbell.start(ring))) {
+        std::cerr << "[server] table " << t.index << ": event loop setup failed: " << std::strerror(errno) << "\n";
+        if (tfd >= 0) close(tfd);
+        if (ep >= 0) close(ep);
+        return;
+    }
+    int betFd = useMq ? static_cast<int>(mq) : doorbell.evfd;
+    for (int fd : {betFd, tfd, t.stopFd}) {
+        struct epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev);
+    }
+    auto armedDeadline = Clock::time_point::min();
+    bool running = true;
+
+    while (running) {
+        auto nextDeadline = engine.next_deadline();
+        if (nextDeadline != armedDeadline) {
+            arm_timer(tfd, nextDeadline);
+            armedDeadline = nextDeadline;
         }
-        // update instrumentation: semaphore value + mq count
-        if (semOk) {
-            int sval = 0;
-            sem_getvalue(sem, &sval);
-            shm.state->sem_value = sval;
+
+        struct epoll_event events[4];
+        int nev = epoll_wait(ep, events, 4, -1);
+        stamps.wakeNs = casino::monotonic_ns();
+        if (nev < 0 && errno != EINTR) {
+            std::cerr << "[server] epoll_wait failed: " << std::strerror(errno) << "\n";
+            break;
         }
-        struct mq_attr curAttr{};
-        if (mq_getattr(mq, &curAttr) == 0) {
-            shm.state->mq_count = static_cast<int32_t>(curAttr.mq_curmsgs);
+        bool timerFired = false;
+        bool doorbellRang = false;
+        for (int e = 0; e < nev; ++e) {
+            int fd = events[e].data.fd;
+            if (fd == t.stopFd) {
+                running = false;
+            } else if (fd == tfd) {
+                uint64_t expirations = 0;
+                if (read(tfd, &expirations, sizeof(expirations)) < 0) { /* EAGAIN after re-arm */ }
+                timerFired = true;
+                if (expirations > 0) jitter.record(armedDeadline, Clock::now());
+                armedDeadline = Clock::time_point::min();
+            } else if (fd == doorbell.evfd) {
+                doorbellRang = true;
+            }
         }
-        shm.state->mutex_held = 0;
-        pthread_mutex_unlock(&shm.state->mutex);
+        if (!running) break;
+        step(timerFired, doorbellRang);
+    }
+
+    doorbell.shutdown();
+    close(tfd);
+    close(ep);
+    jitter.report(t.index, false);
+}
 
-        std::this_thread::sleep_for(16ms);
+// Segment of an offline run (--replay, --virtual-time): an anonymous shared
+// mapping, so the process-shared mutex and seqlock work as in a named segment
+// but nothing is visible to other processes.
+bool map_private_segment(const casino::SegmentConfig& cfg, casino::SharedHandle& shm) {
+    casino::SegmentLayout layout{};
+    if (!casino::compute_layout(cfg, layout)) return false;
+    shm.size = static_cast<size_t>(layout.segmentSize);
+    void* addr = mmap(nullptr, shm.size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED) {
+        std::cerr << "[server] mmap failed: " << std::strerror(errno) << "\n";
+        return false;
     }
+    shm.state = static_cast<casino::SharedState*>(addr);
+    casino::initialize_state(shm.state, cfg);
+    return true;
+}
+
+// Re-executes a journal on a private segment with no sleeps: each LOOP record
+// is fed to a fresh engine at its recorded time, and every rolled spin and
+// committed state digest must match the journal. Returns the exit code.
+int replay_journal(const std::string& path) {
+    casino::JournalReader j;
+    if (!casino::journal_open(j, path)) return 1;
+    const casino::JournalHeader& meta = *j.header;
 
-    mq_close(mq);
-    if (semOk) {
-        sem_close(sem);
-        sem_unlink(casino::SEM_NAME);
+    ServerOptions opt{};
+    opt.seed = static_cast<unsigned int>(meta.seed);
+    opt.tables = std::max(1, meta.tableCount);
+    opt.randomStarts = meta.randomStarts != 0;
+    opt.betTtlMs = meta.betTtlMs;
+    casino::SegmentConfig cfg{};
+    cfg.capacity = static_cast<uint32_t>(std::max(1, meta.seats));
+    cfg.tableId = static_cast<uint32_t>(meta.tableId);
+    cfg.tableCount = static_cast<uint32_t>(opt.tables);
+    casino::SharedHandle shm{};
+    if (!map_private_segment(cfg, shm)) {
+        std::cerr << "[replay] bad journal header\n";
+        casino::journal_close(j);
+        return 1;
+    }
+
+    TableEngine engine;
+    engine.wakeReaders = false;
+    const auto epoch = std::chrono::steady_clock::time_point{};
+    engine.init(shm.state, engine_config(opt), meta.tableId, static_cast<int>(cfg.capacity), epoch);
+
+    std::vector<casino::BetMessage> bets;
+    uint64_t loops = 0, betCount = 0, spins = 0, commits = 0;
+    uint64_t i = 0;
+    uint64_t loopIndex = 0; // first record of the iteration being replayed
+    std::string divergence;
+    auto started = std::chrono::steady_clock::now();
+    while (i < j.count && divergence.empty()) {
+        loopIndex = i;
+        const casino::JournalRecord& loop = j.records[i++];
+        if (loop.type != casino::JOURNAL_LOOP) {
+            divergence = "expected a LOOP record";
+            break;
+        }
+        bets.clear();
+        for (int b = 0; b < loop.b && i < j.count && j.records[i].type == casino::JOURNAL_BET; ++b, ++i) {
+            casino::BetMessage msg{};
+            msg.playerId = j.records[i].seat;
+            msg.amount = j.records[i].a;
+            msg.spins = j.records[i].b;
+            bets.push_back(msg);
+        }
+        auto now = epoch + std::chrono::nanoseconds(loop.t);
+        bool publish = engine.roll(now, bets, loop.a != 0);
+        if (publish) engine.commit(now, TickSample{});
+        loops++;
+        betCount += bets.size();
+
+        size_t s = 0;
+        for (; i < j.count && j.records[i].type == casino::JOURNAL_SPIN; ++i, ++s) {
+            const casino::JournalRecord& want = j.records[i];
+            if (s >= engine.batch.size()) {
+                divergence = "journal has more spins than the replay rolled";
+                break;
+            }
+            casino::JournalRecord got = spin_record(want.t, engine.batch[s], s >= engine.betSpins);
+            if (got.seat != want.seat || got.a != want.a || got.b != want.b || got.c != want.c) {
+                divergence = "spin of seat " + std::to_string(want.seat) + " differs";
+                break;
+            }
+        }
+        if (!divergence.empty()) break;
+        spins += s;
+        if (i == j.count) break; // journal cut short mid-iteration
+        if (s != engine.batch.size()) {
+            divergence = "replay rolled " + std::to_string(engine.batch.size()) + " spins, journal has " + std::to_string(s);
+        } else if (publish != (j.records[i].type == casino::JOURNAL_COMMIT)) {
+            divergence = publish ? "replay committed, journal did not" : "journal committed, replay did not";
+        } else if (publish) {
+            if (j.records[i].c != state_digest(shm.state, engine.originNs)) divergence = "state digest differs after commit";
+            commits++;
+            i++;
+        }
+    }
+    if (!divergence.empty()) {
+        std::cerr << "[replay] divergence in the iteration at record " << loopIndex << " (t="
+                  << j.records[loopIndex].t << " ns): " << divergence << "\n";
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+
+    std::cout << "[replay] " << path << ": table " << meta.tableId << "/" << opt.tables << ", seed " << meta.seed << ", "
+              << loops << " loops, " << betCount << " bets, " << spins << " spins, " << commits << " commits in " << ms
+              << " ms: " << (divergence.empty() ? "state evolution reproduced" : "DIVERGED") << "\n";
+    std::cout << "[replay] final tick=" << shm.state->tick << " jackpot=" << shm.state->jackpot
+              << " rounds=" << shm.state->rounds << "\n";
+    munmap(shm.state, shm.size);
+    casino::journal_close(j);
+    return divergence.empty() ? 0 : 1;
+}
+
+// One bet of a virtual-time run, at `t` on the table's simulated clock.
+struct VirtualBet {
+    std::chrono::nanoseconds t{0};
+    int seat = 0;
+    int amount = 0;
+    int spins = 1; // BetEntry::spins
+};
+
+// --bet-script: "<ms> <player id> <amount> [spins]" per line ('#' starts a
+// comment; spins as in BetEntry, default 1), routed like live players
+// (table id % T, seat id / T). Sorted by time here.
+bool load_bet_script(const std::string& path, const ServerOptions& opt, std::vector<std::vector<VirtualBet>>& perTable) {
+    std::ifstream f(path);
+    if (!f) {
+        std::cerr << "[virtual] cannot read bet script " << path << "\n";
+        return false;
+    }
+    perTable.assign(opt.tables, {});
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(f, line)) {
+        lineNo++;
+        line = line.substr(0, line.find('#'));
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+        std::istringstream in(line);
+        double ms = 0.0;
+        int id = -1;
+        int amount = 0;
+        int spins = 1;
+        if (!(in >> ms >> id >> amount) || ms < 0.0 || id < 0 || (!(in >> spins) && !in.eof()) || spins < 0) {
+            std::cerr << "[virtual] " << path << ":" << lineNo << ": expected \"<ms> <player id> <amount> [spins]\"\n";
+            return false;
+        }
+        VirtualBet bet;
+        bet.t = std::chrono::nanoseconds(static_cast<int64_t>(ms * 1e6));
+        bet.seat = casino::seat_of_player(id, opt.tables); // out-of-range seats are judged invalid, as live
+        bet.amount = amount;
+        bet.spins = spins;
+        perTable[casino::table_of_player(id, opt.tables)].push_back(bet);
+    }
+    for (auto& bets : perTable) {
+        std::stable_sort(bets.begin(), bets.end(), [](const VirtualBet& a, const VirtualBet& b) { return a.t < b.t; });
+    }
+    return true;
+}
+
+// Bet source of a virtual run: the script, or one `player` per seat with that
+// program's cadence (first bet after jitter + lane * 150 ms, then every
+// 1200 + lane * 320 ms plus 600..1800 ms of jitter, amounts 10..120, each bet
+// held back until the seat's published cooldown ends).
+class VirtualBets {
+public:
+    using ReadyAt = std::function<std::chrono::nanoseconds(int seat)>;
+
+    VirtualBets(const std::vector<VirtualBet>* script, int seats, unsigned int seed, ReadyAt readyAt)
+        : script_(script), readyAt_(std::move(readyAt)) {
+        if (script_) return;
+        rng_.seed(seed);
+        for (int seat = 0; seat < seats; ++seat) {
+            int lane = seat % casino::DEFAULT_PLAYERS;
+            std::uniform_int_distribution<int> startJitter(0, 1200);
+            queue_.push({std::chrono::milliseconds(startJitter(rng_) + lane * 150), seat, 0});
+        }
+    }
+
+    std::chrono::nanoseconds next() const {
+        if (script_) return cursor_ < script_->size() ? (*script_)[cursor_].t : std::chrono::nanoseconds::max();
+        return queue_.empty() ? std::chrono::nanoseconds::max() : queue_.top().t;
+    }
+
+    // False when the due bet went back to sleep until its seat's cooldown end.
+    bool pop(VirtualBet& out) {
+        if (script_) {
+            out = (*script_)[cursor_++];
+            return true;
+        }
+        VirtualBet bet = queue_.top();
+        queue_.pop();
+        const std::chrono::nanoseconds ready = readyAt_(bet.seat);
+        if (bet.t < ready) {
+            queue_.push({ready, bet.seat, 0, 1});
+            return false;
+        }
+        bet.amount = std::uniform_int_distribution<int>(10, 120)(rng_);
+        int lane = bet.seat % casino::DEFAULT_PLAYERS;
+        int pause = 1200 + lane * 320 + std::uniform_int_distribution<int>(600, 1800)(rng_);
+        queue_.push({bet.t + std::chrono::milliseconds(pause), bet.seat, 0, 1});
+        out = bet;
+        return true;
+    }
+
+private:
+    struct Later {
+        bool operator()(const VirtualBet& a, const VirtualBet& b) const {
+            return a.t != b.t ? a.t > b.t : a.seat > b.seat;
+        }
+    };
+    const std::vector<VirtualBet>* script_ = nullptr;
+    ReadyAt readyAt_;
+    size_t cursor_ = 0;
+    std::mt19937 rng_;
+    std::priority_queue<VirtualBet, std::vector<VirtualBet>, Later> queue_;
+};
+
+// Long-horizon figures of one virtual table.
+struct VirtualReport {
+    int table = 0;
+    double wallSeconds = 0.0;
+    uint64_t loops = 0;
+    uint64_t commits = 0;
+    uint64_t bets = 0;
+    uint64_t verdicts[casino::BET_VERDICTS] = {};
+    uint64_t spins = 0;
+    uint64_t randomSpins = 0;
+    uint64_t payouts = 0;
+    int64_t jackpotMin = 0;
+    int64_t jackpotMax = 0;
+    uint64_t bankEmpty = 0; // commits that left the jackpot at 0
+    std::vector<uint64_t> seatSpins;
+    std::vector<int64_t> seatNet;
+    uint64_t finalTick = 0;
+    int64_t finalJackpot = 0;
+    uint64_t deferred = 0;
+    uint64_t coalesced = 0;
+    uint64_t expired = 0;
+};
+
+// Runs one table on a simulated clock, as fast as the CPU allows. Time jumps
+// from event to event: the next bet, or the deadline serve_table would have
+// armed its timer on (cooldown end of a held bet, random start). The engine sees the same inputs at the same instants as in real
+// time, minus scheduling jitter. Works on a private segment; --journal records
+// the run for --replay.
+bool simulate_table(int index, int seats, const ServerOptions& opt, const std::vector<VirtualBet>* script,
+                    VirtualReport& report) {
+    casino::SegmentConfig cfg = opt.segCfg;
+    cfg.capacity = static_cast<uint32_t>(seats);
+    cfg.tableId = static_cast<uint32_t>(index);
+    cfg.tableCount = static_cast<uint32_t>(opt.tables);
+    casino::SharedHandle shm{};
+    if (!map_private_segment(cfg, shm)) return false;
+    casino::JournalWriter journal{};
+    if (!opt.journalPath.empty() && !open_table_journal(journal, opt, index, seats)) {
+        munmap(shm.state, shm.size);
+        return false;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const auto epoch = Clock::time_point{};
+    const auto end = epoch + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(opt.virtualSeconds));
+    TableEngine engine;
+    engine.wakeReaders = false;
+    engine.init(shm.state, engine_config(opt), index, seats, epoch);
+    VirtualBets source(script, seats, opt.seed ^ (0x5BD1E995u * static_cast<unsigned int>(index + 1)),
+                       [&engine, epoch](int seat) { return engine.timers[seat].nextAllowed - epoch; });
+
+    report = VirtualReport{};
+    report.table = index;
+    report.seatSpins.assign(seats, 0);
+    report.seatNet.assign(seats, 0);
+    report.jackpotMin = report.jackpotMax = shm.state->jackpot;
+
+    auto armedDeadline = Clock::time_point::min();
+    auto nextTimer = Clock::time_point::max();
+    auto now = epoch;
+    std::vector<casino::BetMessage> pending;
+    const auto started = Clock::now();
+
+    while (true) {
+        // same arming rule as serve_table, on the simulated clock
+        auto nextDeadline = engine.next_deadline();
+        if (nextDeadline != armedDeadline) {
+            nextTimer = nextDeadline == Clock::time_point::max() ? nextDeadline : std::max(nextDeadline, now);
+            armedDeadline = nextDeadline;
+        }
+        const auto nextBet = source.next() == std::chrono::nanoseconds::max() ? Clock::time_point::max()
+                                                                               : epoch + source.next();
+        now = std::min(nextTimer, nextBet);
+        if (now > end) break;
+
+        bool timerFired = nextTimer <= now;
+        if (timerFired) {
+            nextTimer = Clock::time_point::max();
+            armedDeadline = Clock::time_point::min();
+        }
+        pending.clear();
+        while (source.next() != std::chrono::nanoseconds::max() && epoch + source.next() <= now) {
+            VirtualBet bet;
+            if (source.pop(bet)) pending.push_back(casino::BetMessage{bet.seat, bet.amount, 0, bet.spins});
+        }
+
+        bool publish = engine.roll(now, pending, timerFired);
+        if (publish) engine.commit(now, TickSample{});
+        if (journal.header && (publish || !pending.empty())) {
+            journal_step(journal, static_cast<uint64_t>((now - epoch).count()), pending, timerFired, engine, publish);
+        }
+
+        report.loops++;
+        report.bets += pending.size();
+        for (uint8_t v : engine.verdicts) report.verdicts[v]++;
+        for (size_t i = 0; i < engine.batch.size(); ++i) {
+            const SpinOutcome& o = engine.batch[i];
+            report.spins++;
+            report.randomSpins += i >= engine.betSpins ? 1 : 0;
+            report.payouts += static_cast<uint64_t>(o.payout);
+            report.seatSpins[o.playerId]++;
+            report.seatNet[o.playerId] += o.delta;
+        }
+        if (publish) {
+            report.commits++;
+            const int64_t jackpot = shm.state->jackpot;
+            report.jackpotMin = std::min(report.jackpotMin, jackpot);
+            report.jackpotMax = std::max(report.jackpotMax, jackpot);
+            if (jackpot == 0 && !engine.batch.empty()) report.bankEmpty++;
+        }
+    }
+
+    report.wallSeconds = std::chrono::duration<double>(Clock::now() - started).count();
+    report.finalTick = shm.state->tick;
+    report.finalJackpot = shm.state->jackpot;
+    report.deferred = engine.deferred;
+    report.coalesced = engine.coalesced;
+    report.expired = engine.expired;
+    casino::journal_close(journal);
+    munmap(shm.state, shm.size);
+    return true;
+}
+
+void print_virtual_report(const VirtualReport& r, double simulatedSeconds) {
+    std::cout << "[virtual] table " << r.table << ": " << simulatedSeconds << " s simulated in " << r.wallSeconds
+              << " s (x" << static_cast<uint64_t>(simulatedSeconds / std::max(r.wallSeconds, 1e-9)) << "), "
+              << r.loops << " loops, " << r.commits << " commits, final tick " << r.finalTick << "\n";
+    std::cout << "[virtual]   bets " << r.bets << " (accepted " << r.verdicts[casino::BET_ACCEPTED] << ", cooldown "
+              << r.verdicts[casino::BET_COOLDOWN] << ", invalid " << r.verdicts[casino::BET_INVALID] << "), spins "
+              << r.spins << " (random starts " << r.randomSpins << ")";
+    if (r.spins > 0) {
+        std::cout << ", RTP " << static_cast<double>(r.payouts) / (static_cast<double>(r.spins) * casino::SPIN_COST);
+    }
+    std::cout << "\n[virtual]   held bets " << r.deferred << ", coalesced " << r.coalesced << ", expired " << r.expired;
+    std::cout << "\n[virtual]   jackpot final " << r.finalJackpot << ", min " << r.jackpotMin << ", max " << r.jackpotMax
+              << ", commits that emptied the bank " << r.bankEmpty << "\n";
+    if (!r.seatSpins.empty()) {
+        auto spins = std::minmax_element(r.seatSpins.begin(), r.seatSpins.end());
+        auto net = std::minmax_element(r.seatNet.begin(), r.seatNet.end());
+        std::cout << "[virtual]   spins per seat min/mean/max " << *spins.first << "/"
+                  << static_cast<double>(r.spins) / static_cast<double>(r.seatSpins.size()) << "/" << *spins.second
+                  << ", net per seat min/max " << *net.first << "/" << *net.second << "\n";
+    }
+}
+
+// --virtual-time: every table on its own thread and simulated clock, no
+// named segment, MQ or signals. Returns the exit code.
+int run_virtual(const ServerOptions& opt) {
+    std::vector<std::vector<VirtualBet>> script;
+    if (!opt.betScript.empty() && !load_bet_script(opt.betScript, opt, script)) return 1;
+    std::cout << "[virtual] " << opt.virtualSeconds << " s per table, players=" << opt.playerCount
+              << " tables=" << opt.tables << " seed=" << opt.seed << " bets="
+              << (opt.betScript.empty() ? "player cadence" : opt.betScript) << "\n";
+    std::vector<VirtualReport> reports(opt.tables);
+    std::vector<char> ok(opt.tables, 0);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < opt.tables; ++i) {
+        int seats = (opt.playerCount - i + opt.tables - 1) / opt.tables;
+        workers.emplace_back([&, i, seats] {
+            ok[i] = simulate_table(i, seats, opt, script.empty() ? nullptr : &script[i], reports[i]) ? 1 : 0;
+        });
+    }
+    for (auto& w : workers) w.join();
+    int rc = 0;
+    for (int i = 0; i < opt.tables; ++i) {
+        if (ok[i]) {
+            print_virtual_report(reports[i], opt.virtualSeconds);
+        } else {
+            rc = 1;
+        }
+    }
+    return rc;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    ServerOptions opt{};
+    opt.seed = static_cast<unsigned int>(std::random_device{}());
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--players" && i + 1 < argc) {
+            opt.playerCount = std::atoi(argv[++i]);
+            if (opt.playerCount < 1) opt.playerCount = 1;
+        } else if (arg == "--tables" && i + 1 < argc) {
+            opt.tables = std::clamp(std::atoi(argv[++i]), 1, casino::MAX_TABLES);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            opt.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--bets" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            opt.transport = (mode == "mq") ? casino::BET_TRANSPORT_MQ : casino::BET_TRANSPORT_RING;
+        } else if (arg == "--ring-slots" && i + 1 < argc) {
+            // round up to the power of two the ring indexing needs
+            uint32_t want = static_cast<uint32_t>(std::max(2L, std::atol(argv[++i])));
+            uint32_t slots = 2;
+            while (slots < want && slots < (1u << 30)) slots <<= 1;
+            opt.segCfg.betRingSlots = slots;
+        } else if (arg == "--event-slots" && i + 1 < argc) {
+            uint32_t want = static_cast<uint32_t>(std::max(2L, std::atol(argv[++i])));
+            uint32_t slots = 2;
+            while (slots < want && slots < (1u << 24)) slots <<= 1;
+            opt.segCfg.eventRingSlots = slots;
+        } else if (arg == "--no-random-starts") {
+            opt.randomStarts = false;
+        } else if (arg == "--lock-profile") {
+            opt.segCfg.lockProfile = 1;
+        } else if (arg == "--bet-ttl-ms" && i + 1 < argc) {
+            opt.betTtlMs = std::clamp(std::atoi(argv[++i]), 0, 3600000);
+        } else if (arg == "--journal" && i + 1 < argc) {
+            opt.journalPath = argv[++i];
+        } else if (arg == "--state-file" && i + 1 < argc) {
+            // exported so every helper of this process resolves the same files
+            setenv(casino::STATE_FILE_ENV, argv[++i], 1);
+        } else if (arg == "--sync-ms" && i + 1 < argc) {
+            opt.syncMs = std::clamp(std::atoi(argv[++i]), 10, 3600000);
+        } else if (arg == "--virtual-time" && i + 1 < argc) {
+            opt.virtualSeconds = std::max(0.0, std::atof(argv[++i]));
+        } else if (arg == "--realtime") {
+            opt.realtime = true;
+        } else if (arg == "--cpus" && i + 1 < argc) {
+            std::stringstream list(argv[++i]);
+            std::string cpu;
+            while (std::getline(list, cpu, ',')) {
+                if (!cpu.empty()) opt.cpus.push_back(std::max(0, std::atoi(cpu.c_str())));
+            }
+        } else if (arg == "--fifo" && i + 1 < argc) {
+            opt.fifoPriority = std::clamp(std::atoi(argv[++i]), 0, 99);
+        } else if (arg == "--spin-us" && i + 1 < argc) {
+            opt.spinUs = std::clamp(std::atoi(argv[++i]), 1, 1000000);
+        } else if (arg == "--bet-script" && i + 1 < argc) {
+            opt.betScript = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            // offline: no segment, MQ or signals, just the journal
+            return replay_journal(argv[++i]);
+        }
+    }
+    // every table needs at least one seat
+    opt.tables = std::min(opt.tables, opt.playerCount);
+    if (opt.virtualSeconds > 0.0) return run_virtual(opt);
+
+    std::cout << "[server] starting with players=" << opt.playerCount << " tables=" << opt.tables << " seed=" << opt.seed
+              << " bets=" << (opt.transport == casino::BET_TRANSPORT_MQ ? "mq" : "ring")
+              << (opt.realtime ? " realtime (spin <= " + std::to_string(opt.spinUs) + " us)" : std::string())
+              << (opt.fifoPriority > 0 ? " SCHED_FIFO " + std::to_string(opt.fifoPriority) : std::string()) << "\n";
+
+    if (opt.realtime && std::thread::hardware_concurrency() < 2) {
+        std::cerr << "[server] --realtime on a single CPU: busy-polling table loops delay the bet producers\n";
+    }
+
+    // SIGINT/SIGTERM are collected by the main thread with sigwaitinfo; block them
+    // before any thread starts so workers and doorbells never receive them.
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, nullptr);
+
+    std::vector<Table> tables(opt.tables);
+    for (int i = 0; i < opt.tables; ++i) {
+        tables[i].index = i;
+        tables[i].seats = (opt.playerCount - i + opt.tables - 1) / opt.tables;
+        if (!open_table(tables[i], opt)) {
+            for (int j = 0; j < i; ++j) close_table(tables[j]);
+            return 1;
+        }
+    }
+    for (auto& t : tables) {
+        t.worker = std::thread(serve_table, std::ref(t), std::cref(opt));
+    }
+
+    // File-backed tables are flushed from this otherwise idle thread, never from
+    // a table's loop. Without --state-file this is a plain wait for the signal.
+    const bool fileBacked = !casino::state_file_path(0).empty();
+    int sig = -1;
+    while (sig < 0) {
+        if (!fileBacked) {
+            sig = sigwaitinfo(&stopSignals, nullptr);
+            continue;
+        }
+        struct timespec period{opt.syncMs / 1000, static_cast<long>(opt.syncMs % 1000) * 1000000L};
+        sig = sigtimedwait(&stopSignals, nullptr, &period);
+        if (sig < 0 && errno == EAGAIN) {
+            for (auto& t : tables) casino::sync_segment(t.shm, true);
+        }
+    }
+    std::cout << "[server] signal " << sig << ", stopping " << opt.tables << " table(s)\n";
+    for (auto& t : tables) {
+        uint64_t one = 1;
+        if (write(t.stopFd, &one, sizeof(one)) < 0) { /* counter saturated: already stopping */ }
+        t.stopping.store(true, std::memory_order_relaxed);
+        casino::bet_ring_kick(casino::bet_ring_of(t.shm.state));
+    }
+    for (auto& t : tables) {
+        t.worker.join();
+        if (t.shm.fileBacked) {
+            // workers are gone: mark the state adoptable once it is on disk
+            casino::sync_segment(t.shm, true);
+            t.shm.state->header.clean.store(1, std::memory_order_release);
+            casino::sync_segment(t.shm, true);
+        }
+        close_table(t);
     }
-    casino::close_shared_memory(shm);
-    std::cout << "[server] stopped" << std::endl;
+    std::cout << "[server] stopped" << (fileBacked ? ", state saved to " + casino::state_file_path(0) : std::string())
+              << std::endl;
     return 0;
 }
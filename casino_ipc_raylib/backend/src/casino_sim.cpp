@@ -0,0 +1,186 @@
+// Headless Monte Carlo of the slot paytable: the server's spin logic
+// (slot_math: alias tables + batched xoshiro, SPIN_COST, spin_payout) without
+// any IPC, split across threads. Results are exact integer tallies, so a run
+// is reproducible for a given --seed and --threads.
+//
+//   casino_sim [--spins N] [--threads T] [--seed S] [--bank B] [--horizon H]
+#include "slot_math.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t SIM_BATCH = 1 << 16; // spins drawn per draw_stops call
+
+struct SimOptions {
+    uint64_t spins = 100000000ull;
+    int threads = 0; // 0: hardware concurrency
+    uint64_t seed = 1;
+    int64_t bank = 1200;      // starting jackpot of a session
+    uint64_t horizon = 1000;  // spins per session for the ruin estimate
+};
+
+// Exact per-thread tallies; merged by addition so the order never matters.
+struct SimTally {
+    uint64_t spins = 0;
+    uint64_t hits = 0;
+    uint64_t payoutSum = 0;
+    uint64_t payoutSqSum = 0;
+    uint64_t sessions = 0;
+    uint64_t ruined = 0;
+    uint64_t ruinSpinSum = 0; // spins played before ruin, over ruined sessions
+};
+
+uint64_t thread_seed(uint64_t seed, int index) {
+    // distinct, well-mixed stream per thread (splitmix64 finaliser)
+    uint64_t z = seed + 0x9E3779B97F4A7C15ull * static_cast<uint64_t>(index + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Plays `spins` spins as consecutive sessions of `horizon` spins, each starting
+// from `bank`. The bank follows the server: jackpot += payout - SPIN_COST, and
+// a session is ruined the first time it reaches 0.
+void simulate(const SimOptions& opt, int index, uint64_t spins, SimTally& out) {
+    casino::ReelSampler sampler;
+    casino::reel_sampler_init(sampler, thread_seed(opt.seed, index));
+    std::vector<uint8_t> stops(SIM_BATCH * casino::REEL_COUNT);
+
+    SimTally t{};
+    int64_t bank = opt.bank;
+    uint64_t sessionSpins = 0;
+    uint64_t ruinedAt = 0; // spin index (1-based) of this session's ruin, 0 if solvent
+    uint64_t left = spins;
+    while (left > 0) {
+        size_t n = static_cast<size_t>(std::min<uint64_t>(left, SIM_BATCH));
+        casino::draw_stops(sampler, stops.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            int32_t payout = casino::spin_payout(&stops[i * casino::REEL_COUNT]);
+            t.hits += payout > 0;
+            t.payoutSum += static_cast<uint64_t>(payout);
+            t.payoutSqSum += static_cast<uint64_t>(payout) * static_cast<uint64_t>(payout);
+            if (ruinedAt == 0) {
+                bank += payout - casino::SPIN_COST;
+                if (bank <= 0) ruinedAt = sessionSpins + 1;
+            }
+            // only complete sessions count towards the ruin estimate
+            if (++sessionSpins == opt.horizon) {
+                t.sessions++;
+                if (ruinedAt != 0) {
+                    t.ruined++;
+                    t.ruinSpinSum += ruinedAt;
+                }
+                bank = opt.bank;
+                sessionSpins = 0;
+                ruinedAt = 0;
+            }
+        }
+        t.spins += n;
+        left -= n;
+    }
+    out = t;
+}
+
+// Closed-form RTP of the paytable: sum over symbols of P(three alike) * payout.
+double exact_rtp() {
+    uint64_t total = 0;
+    for (uint32_t w : casino::SYMBOL_WEIGHTS) total += w;
+    double expected = 0.0;
+    for (int s = 0; s < casino::SYMBOL_COUNT; ++s) {
+        double p = static_cast<double>(casino::SYMBOL_WEIGHTS[s]) / static_cast<double>(total);
+        expected += p * p * p * casino::SYMBOL_PAYOUTS[s];
+    }
+    return expected / casino::SPIN_COST;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    SimOptions opt{};
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--spins" && i + 1 < argc) {
+            opt.spins = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            opt.threads = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            opt.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--bank" && i + 1 < argc) {
+            opt.bank = std::max(1LL, std::atoll(argv[++i]));
+        } else if (arg == "--horizon" && i + 1 < argc) {
+            opt.horizon = std::max(1ULL, std::strtoull(argv[++i], nullptr, 10));
+        } else {
+            std::fprintf(stderr, "Usage: casino_sim [--spins N] [--threads T] [--seed S] [--bank B] [--horizon H]\n");
+            return 1;
+        }
+    }
+    if (opt.threads == 0) opt.threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    // Thread k always gets the same share and stream, so the totals depend only
+    // on (seed, threads, spins).
+    std::vector<SimTally> tallies(opt.threads);
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int k = 0; k < opt.threads; ++k) {
+        uint64_t share = opt.spins / opt.threads + (static_cast<uint64_t>(k) < opt.spins % opt.threads ? 1 : 0);
+        workers.emplace_back(simulate, std::cref(opt), k, share, std::ref(tallies[k]));
+    }
+    for (auto& w : workers) w.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    SimTally all{};
+    for (const auto& t : tallies) {
+        all.spins += t.spins;
+        all.hits += t.hits;
+        all.payoutSum += t.payoutSum;
+        all.payoutSqSum += t.payoutSqSum;
+        all.sessions += t.sessions;
+        all.ruined += t.ruined;
+        all.ruinSpinSum += t.ruinSpinSum;
+    }
+    if (all.spins == 0) {
+        std::fprintf(stderr, "[sim] no spins\n");
+        return 1;
+    }
+
+    const double n = static_cast<double>(all.spins);
+    const double cost = casino::SPIN_COST;
+    const double meanPayout = static_cast<double>(all.payoutSum) / n;
+    const double variance = std::max(0.0, static_cast<double>(all.payoutSqSum) / n - meanPayout * meanPayout);
+    const double rtp = meanPayout / cost;
+    const double volatility = std::sqrt(variance) / cost; // std dev of return per unit staked
+    const double rtpHalf = 1.96 * volatility / std::sqrt(n);
+    const double hitRate = static_cast<double>(all.hits) / n;
+    const double hitHalf = 1.96 * std::sqrt(hitRate * (1.0 - hitRate) / n);
+
+    std::printf("spins        %llu (%d threads, seed %llu, %.2f s, %.1f M spins/s)\n",
+                static_cast<unsigned long long>(all.spins), opt.threads, static_cast<unsigned long long>(opt.seed),
+                seconds, n / seconds / 1e6);
+    std::printf("rtp          %.6f +/- %.6f (95%% CI), exact %.6f\n", rtp, rtpHalf, exact_rtp());
+    std::printf("hit rate     %.6f +/- %.6f (95%% CI), 1 in %.2f\n", hitRate, hitHalf, hitRate > 0 ? 1.0 / hitRate : 0.0);
+    std::printf("volatility   %.4f (std dev of return per spin / cost)\n", volatility);
+    if (all.sessions > 0) {
+        const double s = static_cast<double>(all.sessions);
+        const double ruin = static_cast<double>(all.ruined) / s;
+        const double ruinHalf = 1.96 * std::sqrt(ruin * (1.0 - ruin) / s);
+        std::printf("ruin         %.6f +/- %.6f (95%% CI) over %llu sessions of %llu spins from bank %lld\n", ruin,
+                    ruinHalf, static_cast<unsigned long long>(all.sessions), static_cast<unsigned long long>(opt.horizon),
+                    static_cast<long long>(opt.bank));
+        if (all.ruined > 0) {
+            std::printf("ruin after   %.1f spins on average\n",
+                        static_cast<double>(all.ruinSpinSum) / static_cast<double>(all.ruined));
+        }
+    } else {
+        std::printf("ruin         n/a (fewer spins per thread than --horizon %llu)\n",
+                    static_cast<unsigned long long>(opt.horizon));
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "event_ring.hpp"
+
+#include <new>
+
+namespace casino {
+
+namespace {
+
+EventSlot* slots_of(EventRing* ring) { return reinterpret_cast<EventSlot*>(ring + 1); }
+const EventSlot* slots_of(const EventRing* ring) { return reinterpret_cast<const EventSlot*>(ring + 1); }
+
+} // namespace
+
+void event_ring_init(EventRing* ring, uint32_t slots) {
+    new (ring) EventRing();
+    ring->slots = slots;
+    ring->mask = slots - 1;
+    EventSlot* s = slots_of(ring);
+    for (uint32_t i = 0; i < slots; ++i) new (&s[i]) EventSlot();
+}
+
+void event_ring_publish(EventRing* ring, const SpinEvent& ev) {
+    uint64_t n = ring->head.load(std::memory_order_relaxed);
+    EventSlot& slot = slots_of(ring)[n & ring->mask];
+    slot.seq.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.ev = ev;
+    slot.seq.store(2 * n + 2, std::memory_order_release);
+    ring->head.store(n + 1, std::memory_order_release);
+}
+
+EventCursor event_cursor_at_head(const EventRing* ring) {
+    EventCursor c{};
+    c.next = ring->head.load(std::memory_order_acquire);
+    return c;
+}
+
+size_t event_ring_read(const EventRing* ring, EventCursor& cursor, SpinEvent* out, size_t max) {
+    const EventSlot* s = slots_of(ring);
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    if (cursor.next > head) cursor.next = head; // cursor from another segment's lifetime
+    if (head - cursor.next > ring->slots) {
+        // lapped: everything older than one ring's worth is gone
+        cursor.lost += head - ring->slots - cursor.next;
+        cursor.next = head - ring->slots;
+    }
+    size_t taken = 0;
+    while (cursor.next < head && taken < max) {
+        uint64_t n = cursor.next++;
+        const EventSlot& slot = s[n & ring->mask];
+        uint64_t before = slot.seq.load(std::memory_order_acquire);
+        if (before != 2 * n + 2) {
+            // the writer has moved on to a later event in this slot
+            cursor.lost++;
+            continue;
+        }
+        out[taken] = slot.ev;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != before) {
+            cursor.lost++;
+            continue;
+        }
+        taken++;
+    }
+    return taken;
+}
+
+} // namespace casino
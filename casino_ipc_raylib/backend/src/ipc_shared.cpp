@@ -1,9 +1,19 @@
 #include "ipc_shared.hpp"
+#include "bet_ring.hpp"
+#include "event_ring.hpp"
+#include "latency_hist.hpp"
+#include "lock_profile.hpp"
 
+#include <algorithm>
 #include <cerrno>
+#include <cstdlib>
 #include <cstring>
 #include <fcntl.h>
+#include <sys/file.h>
 #include <iostream>
+#include <limits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -14,28 +24,266 @@
 
 namespace casino {
 
-std::optional<SharedHandle> open_shared_memory(bool owner) {
+namespace {
+
+constexpr size_t CACHE_LINE = 64;
+
+bool align_up(uint64_t v, uint64_t a, uint64_t& out) {
+    if (v > std::numeric_limits<uint64_t>::max() - (a - 1)) return false;
+    out = (v + a - 1) / a * a;
+    return true;
+}
+
+bool add_bytes(uint64_t base, uint64_t count, uint64_t stride, uint64_t& out) {
+    if (count != 0 && stride > (std::numeric_limits<uint64_t>::max() - base) / count) return false;
+    out = base + count * stride;
+    return true;
+}
+
+// Process-shared, robust: a crashed holder never leaves the mutex locked.
+bool init_mutex(pthread_mutex_t* m) {
+    pthread_mutexattr_t attr;
+    if (pthread_mutexattr_init(&attr) != 0) {
+        return false;
+    }
+    if (pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED) != 0) {
+        pthread_mutexattr_destroy(&attr);
+        return false;
+    }
+    #ifdef PTHREAD_MUTEX_ROBUST
+    // Make the mutex robust so another process crash won't permanently lock it
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    #endif
+    int rv = pthread_mutex_init(m, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return rv == 0;
+}
+
+// Owner path of a file-backed table: maps the existing state file if it was
+// laid out for `cfg` and holds a consistent state. Logs why it is rejected.
+std::optional<SharedHandle> adopt_state_file(const SegmentConfig& cfg, int table) {
+    const std::string path = state_file_path(table);
+    int fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) return std::nullopt; // first run
+    SegmentLayout layout{};
+    struct stat st{};
+    const char* reason = nullptr;
+    void* addr = MAP_FAILED;
+    if (!compute_layout(cfg, layout) || fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) != layout.segmentSize) {
+        reason = "size does not match the requested layout";
+    } else {
+        addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) reason = "mmap failed";
+    }
+    if (!reason) {
+        const auto* state = static_cast<const SharedState*>(addr);
+        const SegmentHeader& h = state->header;
+        if (!validate_header(state, static_cast<size_t>(st.st_size))) {
+            reason = "header invalid (magic, ABI or checksum)";
+        } else if (h.capacity != cfg.capacity || h.betRingSlots != cfg.betRingSlots || h.tableId != cfg.tableId ||
+                   h.tableCount != cfg.tableCount || h.eventRingSlots != cfg.eventRingSlots) {
+            reason = "laid out for another configuration";
+        } else if (state->seq.load(std::memory_order_acquire) & 1u) {
+            reason = "a writer died inside a publish section";
+        }
+    }
+    if (reason) {
+        std::cerr << "[ipc] rebuilding " << path << ": " << reason << "\n";
+        if (addr != MAP_FAILED) munmap(addr, static_cast<size_t>(st.st_size));
+        close(fd);
+        return std::nullopt;
+    }
+    SharedHandle handle{};
+    handle.fd = fd;
+    handle.state = static_cast<SharedState*>(addr);
+    handle.size = static_cast<size_t>(st.st_size);
+    handle.owner = true;
+    handle.fileBacked = true;
+    handle.adopted = true;
+    return handle;
+}
+
+} // namespace
+
+bool compute_layout(const SegmentConfig& cfg, SegmentLayout& out) {
+    if (cfg.betRingSlots == 0 || (cfg.betRingSlots & (cfg.betRingSlots - 1)) != 0) return false;
+    if (cfg.eventRingSlots == 0 || (cfg.eventRingSlots & (cfg.eventRingSlots - 1)) != 0) return false;
+    SegmentLayout l{};
+    uint64_t end = 0;
+    if (!align_up(sizeof(SharedState), CACHE_LINE, l.playersOffset)) return false;
+    if (!add_bytes(l.playersOffset, cfg.capacity, sizeof(PlayerSeat), end)) return false;
+    // each per-seat array on its own lines: server spin stamps vs player pid writes
+    if (!align_up(end, CACHE_LINE, l.spinStartOffset)) return false;
+    if (!add_bytes(l.spinStartOffset, cfg.capacity, sizeof(uint64_t), end)) return false;
+    if (!align_up(end, CACHE_LINE, l.pulseStartOffset)) return false;
+    if (!add_bytes(l.pulseStartOffset, cfg.capacity, sizeof(uint64_t), end)) return false;
+    if (!align_up(end, CACHE_LINE, l.pulsePeakOffset)) return false;
+    if (!add_bytes(l.pulsePeakOffset, cfg.capacity, sizeof(float), end)) return false;
+    if (!align_up(end, CACHE_LINE, l.pidOffset)) return false;
+    if (!add_bytes(l.pidOffset, cfg.capacity, sizeof(int32_t), end)) return false;
+    // change stamps: read by every reader on each new generation, written with the seats
+    if (!align_up(end, CACHE_LINE, l.seatGenOffset)) return false;
+    if (!add_bytes(l.seatGenOffset, cfg.capacity, sizeof(uint32_t), end)) return false;
+    if (!align_up(end, CACHE_LINE, l.groupGenOffset)) return false;
+    if (!add_bytes(l.groupGenOffset, (uint64_t{cfg.capacity} + SEAT_GROUP - 1) / SEAT_GROUP, sizeof(uint32_t), end)) {
+        return false;
+    }
+    if (!align_up(end, CACHE_LINE, l.betRingOffset)) return false;
+    if (!add_bytes(l.betRingOffset + sizeof(BetRing), cfg.betRingSlots, sizeof(BetSlot), end)) return false;
+    if (!align_up(end, CACHE_LINE, l.eventRingOffset)) return false;
+    if (!add_bytes(l.eventRingOffset + sizeof(EventRing), cfg.eventRingSlots, sizeof(EventSlot), end)) return false;
+    if (!align_up(end, CACHE_LINE, l.latencyOffset)) return false;
+    if (!add_bytes(l.latencyOffset, latency_block_histograms(cfg.capacity), sizeof(LatencyHistogram), end)) return false;
+    if (!align_up(end, CACHE_LINE, l.lockProfileOffset)) return false;
+    if (!add_bytes(l.lockProfileOffset, LOCK_SITES, sizeof(LockSiteProfile), end)) return false;
+    if (end > std::numeric_limits<size_t>::max()) return false;
+    l.segmentSize = end;
+    out = l;
+    return true;
+}
+
+bool validate_header(const SharedState* state, size_t mappedSize) {
+    if (!state || mappedSize < sizeof(SharedState)) return false;
+    const SegmentHeader& h = state->header;
+    if (h.magic.load(std::memory_order_acquire) != SHM_MAGIC) return false;
+    if (h.abiVersion != SHM_ABI_VERSION) {
+        std::cerr << "[ipc] segment ABI " << h.abiVersion << " != expected " << SHM_ABI_VERSION << "\n";
+        return false;
+    }
+    if (h.headerSize != sizeof(SharedState) || h.playerStride != sizeof(PlayerSeat)) return false;
+    SegmentLayout l{};
+    if (!compute_layout(SegmentConfig{h.capacity, h.betRingSlots, h.tableId, h.tableCount, h.eventRingSlots}, l)) return false;
+    if (h.playersOffset != l.playersOffset || h.betRingOffset != l.betRingOffset ||
+        h.eventRingOffset != l.eventRingOffset || h.latencyOffset != l.latencyOffset ||
+        h.lockProfileOffset != l.lockProfileOffset) return false;
+    if (h.spinStartOffset != l.spinStartOffset || h.pulseStartOffset != l.pulseStartOffset ||
+        h.pulsePeakOffset != l.pulsePeakOffset || h.pidOffset != l.pidOffset) return false;
+    if (h.seatGenOffset != l.seatGenOffset || h.groupGenOffset != l.groupGenOffset) return false;
+    if (h.segmentSize != l.segmentSize || h.segmentSize > mappedSize) return false;
+    return h.checksum == header_checksum(h);
+}
+
+uint64_t header_checksum(const SegmentHeader& h) {
+    uint64_t sum = 0xCBF29CE484222325ull;
+    auto mix = [&sum](uint64_t v) {
+        for (int i = 0; i < 8; ++i) {
+            sum ^= (v >> (i * 8)) & 0xFF;
+            sum *= 0x100000001B3ull;
+        }
+    };
+    for (uint64_t v : {uint64_t{h.abiVersion}, uint64_t{h.headerSize}, uint64_t{h.playerStride}, uint64_t{h.capacity},
+                       uint64_t{h.betRingSlots}, uint64_t{h.tableId}, uint64_t{h.tableCount}, uint64_t{h.eventRingSlots},
+                       h.playersOffset, h.spinStartOffset, h.pulseStartOffset, h.pulsePeakOffset, h.pidOffset,
+                       h.betRingOffset, h.eventRingOffset, h.latencyOffset, h.lockProfileOffset, h.segmentSize,
+                       h.spinDurationNs, h.seatGenOffset, h.groupGenOffset}) {
+        mix(v);
+    }
+    return sum;
+}
+
+std::string table_shm_name(int table) {
+    return table == 0 ? std::string(SHM_NAME) : std::string(SHM_NAME) + ".t" + std::to_string(table);
+}
+
+std::string table_mq_name(int table) {
+    return table == 0 ? std::string(MQ_NAME) : std::string(MQ_NAME) + ".t" + std::to_string(table);
+}
+
+std::string state_file_path(int table) {
+    const char* base = std::getenv(STATE_FILE_ENV);
+    if (!base || !*base) return {};
+    return table == 0 ? std::string(base) : std::string(base) + ".t" + std::to_string(table);
+}
+
+int open_segment_fd(int table, int flags, mode_t mode) {
+    const std::string path = state_file_path(table);
+    if (path.empty()) return shm_open(table_shm_name(table).c_str(), flags, mode);
+    return open(path.c_str(), flags | O_CLOEXEC, mode);
+}
+
+void unlink_segment(int table) {
+    const std::string path = state_file_path(table);
+    if (path.empty()) {
+        shm_unlink(table_shm_name(table).c_str());
+    } else {
+        unlink(path.c_str());
+    }
+}
+
+namespace {
+
+// Owner of a file-backed table: takes an exclusive flock on "<file>.lock" and
+// writes its pid there. The lock file is never unlinked (the state file is, on
+// rebuild), so every server started on the same file contends on one inode;
+// the kernel drops the lock when its holder exits or dies. Returns the locked
+// fd, or -1 if another server holds it.
+int lock_state_file(int table) {
+    const std::string path = state_file_path(table);
+    const std::string lockPath = path + ".lock";
+    int fd = open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        std::cerr << "[ipc] open " << lockPath << " failed: " << std::strerror(errno) << "\n";
+        return -1;
+    }
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        if (errno == EWOULDBLOCK) {
+            char pid[32] = {};
+            ssize_t n = pread(fd, pid, sizeof(pid) - 1, 0);
+            while (n > 0 && (pid[n - 1] == '\n' || pid[n - 1] == ' ')) pid[--n] = '\0';
+            std::cerr << "[ipc] " << path << " is in use by another server"
+                      << (n > 0 ? std::string(" (pid ") + pid + ")" : std::string()) << ": not adopting it\n";
+        } else {
+            std::cerr << "[ipc] flock " << lockPath << " failed: " << std::strerror(errno) << "\n";
+        }
+        close(fd);
+        return -1;
+    }
+    const std::string pid = std::to_string(getpid()) + "\n";
+    if (ftruncate(fd, 0) != 0 || pwrite(fd, pid.data(), pid.size(), 0) < 0) { /* pid is for diagnostics only */ }
+    return fd;
+}
+
+// Creates (owner) or opens the segment object and maps it whole.
+std::optional<SharedHandle> map_segment(bool owner, const SegmentConfig& cfg, int table) {
+    const bool fileBacked = !state_file_path(table).empty();
     int flags = O_RDWR;
     if (owner) {
-        // ensure we start fresh
-        shm_unlink(SHM_NAME);
+        // ensure we start fresh: attachers of the old object see it unlinked
+        unlink_segment(table);
         flags |= O_CREAT;
     }
-    int fd = shm_open(SHM_NAME, flags, 0666);
+    int fd = open_segment_fd(table, flags, 0666);
     if (fd < 0) {
-        std::cerr << "[ipc] shm_open failed: " << std::strerror(errno) << "\n";
+        std::cerr << "[ipc] " << (fileBacked ? "open " + state_file_path(table) : std::string("shm_open"))
+                  << " failed: " << std::strerror(errno) << "\n";
         return std::nullopt;
     }
 
+    size_t size = 0;
     if (owner) {
-        if (ftruncate(fd, sizeof(SharedState)) != 0) {
-            std::cerr << "[ipc] ftruncate failed: " << std::strerror(errno) << "\n";
+        SegmentLayout layout{};
+        if (!compute_layout(cfg, layout)) {
+            std::cerr << "[ipc] invalid segment config (capacity " << cfg.capacity << ", ring " << cfg.betRingSlots << ")\n";
+            close(fd);
+            return std::nullopt;
+        }
+        size = static_cast<size_t>(layout.segmentSize);
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            std::cerr << "[ipc] ftruncate failed for capacity " << cfg.capacity << ": " << std::strerror(errno) << "\n";
+            close(fd);
+            return std::nullopt;
+        }
+    } else {
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SharedState)) {
+            std::cerr << "[ipc] shared segment not ready\n";
             close(fd);
             return std::nullopt;
         }
+        size = static_cast<size_t>(st.st_size);
     }
 
-    void* addr = mmap(nullptr, sizeof(SharedState), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
     if (addr == MAP_FAILED) {
         std::cerr << "[ipc] mmap failed: " << std::strerror(errno) << "\n";
         close(fd);
@@ -45,48 +293,92 @@ std::optional<SharedHandle> open_shared_memory(bool owner) {
     SharedHandle handle{};
     handle.fd = fd;
     handle.state = reinterpret_cast<SharedState*>(addr);
+    handle.size = size;
     handle.owner = owner;
+    handle.fileBacked = fileBacked;
+    if (!owner && !validate_header(handle.state, size)) {
+        std::cerr << "[ipc] shared segment header invalid or not initialised\n";
+        close_shared_memory(handle);
+        return std::nullopt;
+    }
+    return handle;
+}
+
+} // namespace
+
+std::optional<SharedHandle> open_shared_memory(bool owner, const SegmentConfig& cfg, int table) {
+    if (!owner || state_file_path(table).empty()) return map_segment(owner, cfg, table);
+    // a running server owns the file: neither adopt nor rebuild it under its feet
+    int lockFd = lock_state_file(table);
+    if (lockFd < 0) return std::nullopt;
+    auto handle = adopt_state_file(cfg, table);
+    if (!handle) handle = map_segment(true, cfg, table);
+    if (!handle) {
+        close(lockFd);
+        return std::nullopt;
+    }
+    handle->lockFd = lockFd;
+    return handle;
+}
+
+std::optional<SharedHandle> open_shared_memory_readonly(int table) {
+    int fd = open_segment_fd(table, O_RDONLY, 0);
+    if (fd < 0) {
+        std::cerr << "[ipc] open segment of table " << table << " failed: " << std::strerror(errno) << "\n";
+        return std::nullopt;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SharedState)) {
+        std::cerr << "[ipc] shared segment not ready\n";
+        close(fd);
+        return std::nullopt;
+    }
+    SharedHandle handle{};
+    handle.fd = fd;
+    handle.size = static_cast<size_t>(st.st_size);
+    handle.fileBacked = !state_file_path(table).empty();
+    void* addr = mmap(nullptr, handle.size, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        std::cerr << "[ipc] mmap failed: " << std::strerror(errno) << "\n";
+        close(fd);
+        return std::nullopt;
+    }
+    handle.state = static_cast<SharedState*>(addr);
+    if (!validate_header(handle.state, handle.size)) {
+        std::cerr << "[ipc] shared segment header invalid or not initialised\n";
+        close_shared_memory(handle);
+        return std::nullopt;
+    }
     return handle;
 }
 
 void close_shared_memory(SharedHandle& handle) {
     if (handle.state) {
-        munmap(handle.state, sizeof(SharedState));
+        munmap(handle.state, handle.size);
         handle.state = nullptr;
     }
     if (handle.fd >= 0) {
         close(handle.fd);
         handle.fd = -1;
     }
+    if (handle.lockFd >= 0) {
+        close(handle.lockFd); // releases the state file lock
+        handle.lockFd = -1;
+    }
 }
 
-void unlink_ipc() {
-    shm_unlink(SHM_NAME);
-    mq_unlink(MQ_NAME);
-    sem_unlink(SEM_NAME);
+void unlink_ipc(int table) {
+    shm_unlink(table_shm_name(table).c_str());
+    mq_unlink(table_mq_name(table).c_str());
+    sem_unlink(SEM_NAME); // legacy wakeup semaphore of older servers
 }
 
-bool initialize_state(SharedState* state) {
-    if (!state) return false;
+bool initialize_state(SharedState* state, const SegmentConfig& cfg) {
+    SegmentLayout layout{};
+    if (!state || !compute_layout(cfg, layout)) return false;
     // value-initialize SharedState in-place to ensure deterministic fields
     new (state) SharedState();
-    pthread_mutexattr_t attr;
-    if (pthread_mutexattr_init(&attr) != 0) {
-        return false;
-    }
-    if (pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED) != 0) {
-        pthread_mutexattr_destroy(&attr);
-        return false;
-    }
-    #ifdef PTHREAD_MUTEX_ROBUST
-    // Make the mutex robust so another process crash won't permanently lock it
-    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
-    #endif
-    if (pthread_mutex_init(&state->mutex, &attr) != 0) {
-        pthread_mutexattr_destroy(&attr);
-        return false;
-    }
-    pthread_mutexattr_destroy(&attr);
+    if (!init_mutex(&state->mutex)) return false;
 
     state->tick = 0;
     state->jackpot = 0;
@@ -94,11 +386,198 @@ bool initialize_state(SharedState* state) {
     state->lastWinnerId = -1;
     state->lastWinAmount = 0;
     state->playerCount = 0;
-    for (auto& p : state->players) {
-        p = PlayerState{};
+
+    SegmentHeader& h = state->header;
+    h.abiVersion = SHM_ABI_VERSION;
+    h.headerSize = sizeof(SharedState);
+    h.playerStride = sizeof(PlayerSeat);
+    h.capacity = cfg.capacity;
+    h.betRingSlots = cfg.betRingSlots;
+    h.betTransport = BET_TRANSPORT_RING;
+    h.betProtocolMin = BET_PROTOCOL_VERSION;
+    h.betProtocolMax = BET_PROTOCOL_VERSION;
+    h.tableId = cfg.tableId;
+    h.tableCount = cfg.tableCount;
+    h.playersOffset = layout.playersOffset;
+    h.spinStartOffset = layout.spinStartOffset;
+    h.pulseStartOffset = layout.pulseStartOffset;
+    h.pulsePeakOffset = layout.pulsePeakOffset;
+    h.spinDurationNs = static_cast<uint64_t>(SPIN_DURATION_MS) * 1000000ull;
+    h.seatGenOffset = layout.seatGenOffset;
+    h.groupGenOffset = layout.groupGenOffset;
+    h.pidOffset = layout.pidOffset;
+    h.betRingOffset = layout.betRingOffset;
+    h.eventRingSlots = cfg.eventRingSlots;
+    h.eventRingOffset = layout.eventRingOffset;
+    h.latencyOffset = layout.latencyOffset;
+    h.lockProfile = cfg.lockProfile;
+    h.lockProfileOffset = layout.lockProfileOffset;
+    h.segmentSize = layout.segmentSize;
+    h.epoch.store(1, std::memory_order_relaxed);
+    h.checksum = header_checksum(h);
+    PlayerArrays players = players_of(state);
+    for (uint32_t i = 0; i < cfg.capacity; ++i) {
+        new (&players.seats[i]) PlayerSeat();
+        players.spinStartNs[i] = 0;
+        players.pulseStartNs[i] = 0;
+        players.pulsePeak[i] = 0.0f;
+        players.pid[i] = -1;
+        players.seatGen[i] = 0;
     }
+    std::fill_n(players.groupGen, (cfg.capacity + SEAT_GROUP - 1) / SEAT_GROUP, 0u);
+    bet_ring_init(bet_ring_of(state), cfg.betRingSlots);
+    event_ring_init(event_ring_of(state), cfg.eventRingSlots);
+    latency_block_init(latency_block_of(state), latency_block_histograms(cfg.capacity));
+    lock_profile_init(lock_profile_of(state));
+    // publish last: attachers treat the segment as ready once they see the magic
+    h.magic.store(SHM_MAGIC, std::memory_order_release);
     return true;
 }
 
-} // namespace casino
+bool adopt_state(SharedState* state, const SegmentConfig& cfg) {
+    if (!state) return false;
+    // the previous owner is gone: whatever its mutex word says is stale
+    if (!init_mutex(&state->mutex)) return false;
+    SegmentHeader& h = state->header;
+    h.lockProfile = cfg.lockProfile;
+    h.betProtocolMin = BET_PROTOCOL_VERSION;
+    h.betProtocolMax = BET_PROTOCOL_VERSION;
+    h.clean.store(0, std::memory_order_relaxed);
+    // attached readers see a new epoch and re-attach
+    h.epoch.fetch_add(1, std::memory_order_release);
+    return true;
+}
 
+bool sync_segment(const SharedHandle& handle, bool wait) {
+    if (!handle.fileBacked || !handle.state) return true;
+    return msync(handle.state, handle.size, wait ? MS_SYNC : MS_ASYNC) == 0;
+}
+
+std::optional<BetSender> open_bet_sender(SharedState* state, int table, uint32_t senderId) {
+    BetSender sender{};
+    sender.id = senderId != 0 ? senderId : static_cast<uint32_t>(getpid());
+    if (state) {
+        // speak the newest version both ends know
+        const SegmentHeader& h = state->header;
+        if (BET_PROTOCOL_VERSION < h.betProtocolMin) {
+            std::cerr << "[ipc] server wants bet protocol v" << h.betProtocolMin << "..v" << h.betProtocolMax
+                      << ", this build speaks v" << BET_PROTOCOL_VERSION << "\n";
+            return std::nullopt;
+        }
+        sender.version = std::min(BET_PROTOCOL_VERSION, h.betProtocolMax);
+    }
+    if (state && state->header.betTransport == BET_TRANSPORT_RING) {
+        sender.transport = BET_TRANSPORT_RING;
+        sender.ring = bet_ring_of(state);
+        return sender;
+    }
+    sender.mq = mq_open(table_mq_name(table).c_str(), O_WRONLY);
+    if (sender.mq == static_cast<mqd_t>(-1)) {
+        std::cerr << "[ipc] mq_open failed (server not running?): " << std::strerror(errno) << "\n";
+        return std::nullopt;
+    }
+    return sender;
+}
+
+size_t send_bets(BetSender& sender, const BetEntry* bets, size_t count) {
+    size_t sent = 0;
+    while (sent < count) {
+        BetFrame frame{};
+        frame.version = static_cast<uint16_t>(sender.version);
+        frame.count = static_cast<uint16_t>(std::min<size_t>(count - sent, BET_FRAME_MAX));
+        frame.sender = sender.id;
+        frame.seq = sender.seq + 1;
+        frame.sentNs = monotonic_ns();
+        std::copy(bets + sent, bets + sent + frame.count, frame.bets);
+        bool ok = sender.transport == BET_TRANSPORT_RING
+                      ? bet_ring_push(sender.ring, frame)
+                      : mq_send(sender.mq, reinterpret_cast<const char*>(&frame), sizeof(frame), 0) == 0;
+        if (!ok) break;
+        // a frame the channel refused never existed: it leaves no sequence gap
+        sender.seq = frame.seq;
+        sent += frame.count;
+    }
+    return sent;
+}
+
+bool send_bet(BetSender& sender, const BetEntry& bet) {
+    return send_bets(sender, &bet, 1) == 1;
+}
+
+void close_bet_sender(BetSender& sender) {
+    if (sender.mq != static_cast<mqd_t>(-1)) {
+        mq_close(sender.mq);
+        sender.mq = static_cast<mqd_t>(-1);
+    }
+    sender.ring = nullptr;
+}
+
+bool prefault_mapping(void* addr, size_t size, int fd, bool writable) {
+#ifndef MADV_POPULATE_READ
+    constexpr int MADV_POPULATE_READ = 22; // Linux 5.14
+    constexpr int MADV_POPULATE_WRITE = 23;
+#endif
+    // before the first touch: shmem and files only get huge pages when the
+    // kernel allows it (transparent_hugepage/shmem_enabled), otherwise a no-op
+    madvise(addr, size, MADV_HUGEPAGE);
+    if (madvise(addr, size, writable ? MADV_POPULATE_WRITE : MADV_POPULATE_READ) != 0) {
+        const int prot = PROT_READ | (writable ? PROT_WRITE : 0);
+        if (fd < 0 || mmap(addr, size, prot, MAP_SHARED | MAP_FIXED | MAP_POPULATE, fd, 0) == MAP_FAILED) {
+            std::cerr << "[ipc] cannot prefault the segment: " << std::strerror(errno) << "\n";
+            return false;
+        }
+    }
+    if (mlock(addr, size) != 0) {
+        std::cerr << "[ipc] mlock of " << size << " bytes failed (raise RLIMIT_MEMLOCK): " << std::strerror(errno) << "\n";
+        return false;
+    }
+    return true;
+}
+
+void futex_wait(const std::atomic<uint32_t>* word, uint32_t expected, int timeoutMs) {
+    struct timespec ts{};
+    struct timespec* tsp = nullptr;
+    if (timeoutMs >= 0) {
+        ts.tv_sec = timeoutMs / 1000;
+        ts.tv_nsec = static_cast<long>(timeoutMs % 1000) * 1000000L;
+        tsp = &ts;
+    }
+    // shared futex: the word lives in a MAP_SHARED segment used by several processes
+    syscall(SYS_futex, reinterpret_cast<const uint32_t*>(word), FUTEX_WAIT, expected, tsp, nullptr, 0);
+}
+
+void futex_wake(std::atomic<uint32_t>* word, int count) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, count, nullptr, nullptr, 0);
+}
+
+void notify_state_change(SharedState* state) {
+    futex_wake(&state->generation, std::numeric_limits<int>::max());
+}
+
+uint32_t wait_state_change(const SharedState* state, uint32_t seen, int timeoutMs) {
+    uint32_t now = state->generation.load(std::memory_order_acquire);
+    if (now == seen) {
+        futex_wait(&state->generation, seen, timeoutMs);
+        now = state->generation.load(std::memory_order_acquire);
+    }
+    return now;
+}
+
+bool collect_changed_seats(const SharedState* state, const ConstPlayerArrays& players, uint32_t since, int count,
+                           std::vector<uint32_t>& out) {
+    // stamps are compared as signed distances: fine while the reader is less
+    // than 2^30 generations behind (older stamps then only look changed)
+    if (state->generation.load(std::memory_order_relaxed) - since >= (1u << 30)) return false;
+    auto after = [since](uint32_t stamp) { return static_cast<int32_t>(stamp - since) > 0; };
+    const uint32_t seats = static_cast<uint32_t>(std::max(0, count));
+    for (uint32_t g = 0; g * SEAT_GROUP < seats; ++g) {
+        if (!after(players.groupGen[g])) continue;
+        const uint32_t last = std::min(seats, (g + 1) * SEAT_GROUP);
+        for (uint32_t i = g * SEAT_GROUP; i < last; ++i) {
+            if (after(players.seatGen[i])) out.push_back(i);
+        }
+    }
+    return true;
+}
+
+} // namespace casino
@@ -0,0 +1,136 @@
+#include "journal.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace casino {
+
+namespace {
+
+constexpr size_t JOURNAL_CHUNK = 4u << 20; // file growth step (131072 records)
+
+size_t record_offset(uint64_t index) { return sizeof(JournalHeader) + index * sizeof(JournalRecord); }
+
+} // namespace
+
+bool journal_create(JournalWriter& w, const std::string& path, const JournalHeader& meta) {
+    w.fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (w.fd < 0) {
+        std::cerr << "[journal] open " << path << " failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    if (ftruncate(w.fd, static_cast<off_t>(JOURNAL_CHUNK)) != 0) {
+        std::cerr << "[journal] ftruncate failed: " << std::strerror(errno) << "\n";
+        close(w.fd);
+        w.fd = -1;
+        return false;
+    }
+    void* addr = mmap(nullptr, JOURNAL_CHUNK, PROT_READ | PROT_WRITE, MAP_SHARED, w.fd, 0);
+    if (addr == MAP_FAILED) {
+        std::cerr << "[journal] mmap failed: " << std::strerror(errno) << "\n";
+        close(w.fd);
+        w.fd = -1;
+        return false;
+    }
+    w.mapped = JOURNAL_CHUNK;
+    w.header = new (addr) JournalHeader();
+    w.header->magic = JOURNAL_MAGIC;
+    w.header->version = JOURNAL_VERSION;
+    w.header->seed = meta.seed;
+    w.header->tableId = meta.tableId;
+    w.header->tableCount = meta.tableCount;
+    w.header->seats = meta.seats;
+    w.header->randomStarts = meta.randomStarts;
+    w.header->betTtlMs = meta.betTtlMs;
+    w.records = 0;
+    return true;
+}
+
+bool journal_append(JournalWriter& w, const JournalRecord& rec) {
+    if (!w.header) return false;
+    size_t end = record_offset(w.records + 1);
+    if (end > w.mapped) {
+        size_t grown = w.mapped + JOURNAL_CHUNK;
+        void* addr = MAP_FAILED;
+        if (ftruncate(w.fd, static_cast<off_t>(grown)) == 0) {
+            addr = mremap(w.header, w.mapped, grown, MREMAP_MAYMOVE);
+        }
+        if (addr == MAP_FAILED) {
+            std::cerr << "[journal] cannot grow journal: " << std::strerror(errno) << ", recording stopped\n";
+            journal_close(w);
+            return false;
+        }
+        w.header = static_cast<JournalHeader*>(addr);
+        w.mapped = grown;
+    }
+    auto* records = reinterpret_cast<JournalRecord*>(reinterpret_cast<char*>(w.header) + sizeof(JournalHeader));
+    records[w.records] = rec;
+    w.header->records.store(++w.records, std::memory_order_release);
+    return true;
+}
+
+void journal_close(JournalWriter& w) {
+    if (w.header) {
+        munmap(w.header, w.mapped);
+        w.header = nullptr;
+    }
+    if (w.fd >= 0) {
+        if (ftruncate(w.fd, static_cast<off_t>(record_offset(w.records))) != 0) {
+            std::cerr << "[journal] final truncate failed: " << std::strerror(errno) << "\n";
+        }
+        close(w.fd);
+        w.fd = -1;
+    }
+    w.mapped = 0;
+}
+
+bool journal_open(JournalReader& r, const std::string& path) {
+    r.fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st{};
+    if (r.fd < 0 || fstat(r.fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(JournalHeader)) {
+        std::cerr << "[journal] cannot read " << path << "\n";
+        if (r.fd >= 0) close(r.fd);
+        r.fd = -1;
+        return false;
+    }
+    r.mapped = static_cast<size_t>(st.st_size);
+    void* addr = mmap(nullptr, r.mapped, PROT_READ, MAP_SHARED, r.fd, 0);
+    if (addr == MAP_FAILED) {
+        std::cerr << "[journal] mmap failed: " << std::strerror(errno) << "\n";
+        close(r.fd);
+        r.fd = -1;
+        return false;
+    }
+    r.header = static_cast<const JournalHeader*>(addr);
+    if (r.header->magic != JOURNAL_MAGIC || r.header->version != JOURNAL_VERSION) {
+        std::cerr << "[journal] " << path << " is not a version " << JOURNAL_VERSION << " journal\n";
+        journal_close(r);
+        return false;
+    }
+    uint64_t fits = (r.mapped - sizeof(JournalHeader)) / sizeof(JournalRecord);
+    r.count = std::min<uint64_t>(r.header->records.load(std::memory_order_acquire), fits);
+    r.records = reinterpret_cast<const JournalRecord*>(static_cast<const char*>(addr) + sizeof(JournalHeader));
+    return true;
+}
+
+void journal_close(JournalReader& r) {
+    if (r.header) {
+        munmap(const_cast<JournalHeader*>(r.header), r.mapped);
+        r.header = nullptr;
+    }
+    if (r.fd >= 0) {
+        close(r.fd);
+        r.fd = -1;
+    }
+    r.records = nullptr;
+    r.count = 0;
+}
+
+} // namespace casino
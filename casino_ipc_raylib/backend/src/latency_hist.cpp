@@ -0,0 +1,75 @@
+#include "latency_hist.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <new>
+
+namespace casino {
+
+namespace {
+
+void bump(std::atomic<uint64_t>& v, uint64_t by) {
+    // single writer: a plain read-modify-write, no locked instruction
+    v.store(v.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+} // namespace
+
+int latency_bucket(uint64_t ns) {
+    constexpr uint64_t sub = 1u << LAT_SUB_BITS;
+    if (ns < sub) return static_cast<int>(ns);
+    int exp = 63 - __builtin_clzll(ns);
+    if (exp >= LAT_MAX_EXP) return LAT_BUCKETS - 1;
+    int shift = exp - LAT_SUB_BITS;
+    return ((shift + 1) << LAT_SUB_BITS) + static_cast<int>((ns >> shift) - sub);
+}
+
+uint64_t latency_bucket_high(int bucket) {
+    constexpr uint64_t sub = 1u << LAT_SUB_BITS;
+    int group = bucket >> LAT_SUB_BITS;
+    uint64_t index = static_cast<uint64_t>(bucket) & (sub - 1);
+    if (group == 0) return index;
+    int shift = group - 1;
+    return ((sub + index + 1) << shift) - 1;
+}
+
+void latency_block_init(LatencyHistogram* block, uint64_t count) {
+    for (uint64_t i = 0; i < count; ++i) new (&block[i]) LatencyHistogram();
+}
+
+void latency_record(LatencyHistogram& h, uint64_t ns) {
+    bump(h.buckets[latency_bucket(ns)], 1);
+    bump(h.sumNs, ns);
+    if (ns > h.maxNs.load(std::memory_order_relaxed)) h.maxNs.store(ns, std::memory_order_relaxed);
+    // count last: a reader never sees more bets than bucket entries
+    h.count.store(h.count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+LatencySummary latency_summarize(const LatencyHistogram& h) {
+    LatencySummary s{};
+    uint64_t counts[LAT_BUCKETS];
+    uint64_t total = 0;
+    s.count = h.count.load(std::memory_order_acquire);
+    for (int b = 0; b < LAT_BUCKETS; ++b) {
+        counts[b] = h.buckets[b].load(std::memory_order_relaxed);
+        total += counts[b];
+    }
+    s.maxNs = h.maxNs.load(std::memory_order_relaxed);
+    if (total == 0) return s;
+    s.meanNs = static_cast<double>(h.sumNs.load(std::memory_order_relaxed)) / static_cast<double>(total);
+    auto percentile = [&](double q) {
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(total))));
+        uint64_t seen = 0;
+        for (int b = 0; b < LAT_BUCKETS; ++b) {
+            seen += counts[b];
+            if (seen >= rank) return std::min(latency_bucket_high(b), s.maxNs);
+        }
+        return s.maxNs;
+    };
+    s.p50Ns = percentile(0.50);
+    s.p99Ns = percentile(0.99);
+    s.p999Ns = percentile(0.999);
+    return s;
+}
+
+} // namespace casino
@@ -0,0 +1,48 @@
+#include "lock_profile.hpp"
+#include "ipc_shared.hpp"
+#include "latency_hist.hpp"
+
+#include <new>
+
+namespace casino {
+
+const char* lock_site_role(int site) {
+    return site == LOCK_SITE_PLAYER_PID ? "player" : "server";
+}
+
+const char* lock_site_name(int site) {
+    switch (site) {
+    case LOCK_SITE_SERVER_INIT: return "init";
+    case LOCK_SITE_SERVER_SPINS: return "commit(spins)";
+    case LOCK_SITE_SERVER_TICK: return "commit(tick)";
+    case LOCK_SITE_PLAYER_PID: return "pid";
+    default: return "?";
+    }
+}
+
+void lock_profile_init(LockSiteProfile* profiles) {
+    for (int i = 0; i < LOCK_SITES; ++i) new (&profiles[i]) LockSiteProfile();
+}
+
+bool profiled_lock(SharedState* state, LockSite site, ProfiledLock& lock) {
+    lock.state = state;
+    lock.profile = nullptr;
+    if (!state->header.lockProfile) return safe_mutex_lock(&state->mutex);
+    uint64_t start = monotonic_ns();
+    if (!safe_mutex_lock(&state->mutex)) return false;
+    lock.acquiredNs = monotonic_ns();
+    lock.profile = &lock_profile_of(state)[site];
+    latency_record(lock.profile->wait, lock.acquiredNs - start);
+    return true;
+}
+
+void profiled_unlock(ProfiledLock& lock) {
+    if (lock.profile) {
+        // still under the mutex: the hold sample excludes only this record
+        latency_record(lock.profile->hold, monotonic_ns() - lock.acquiredNs);
+        lock.profile = nullptr;
+    }
+    pthread_mutex_unlock(&lock.state->mutex);
+}
+
+} // namespace casino
@@ -1,12 +1,11 @@
 #include "ipc_shared.hpp"
+#include "lock_profile.hpp"
 #include <chrono>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
-#include <mqueue.h>
 #include <random>
 #include <thread>
-#include <semaphore.h>
 #include <unistd.h>
 
 using namespace std::chrono_literals;
@@ -17,22 +16,54 @@ int main(int argc, char** argv) {
         return 1;
     }
     int id = std::atoi(argv[1]);
-    if (id < 0 || id >= casino::MAX_PLAYERS) {
+    if (id < 0) {
         std::cerr << "[player] invalid id" << std::endl;
         return 1;
     }
 
-    mqd_t mq = mq_open(casino::MQ_NAME, O_WRONLY);
-    if (mq == static_cast<mqd_t>(-1)) {
-        std::cerr << "[player] mq_open failed (server not running?)" << std::endl;
-        return 1;
+    // Attach to shared memory: table 0 advertises how many tables the server
+    // runs, and our id picks the table and seat. The table segment validates the
+    // seat against its capacity, receives our pid for diagnostics and tells us
+    // which bet transport to use. Stays mapped for the lifetime of the player
+    // (the bet ring lives in it).
+    int table = 0;
+    int seat = id;
+    auto shOpt = casino::open_shared_memory(false);
+    if (shOpt && shOpt->state->header.tableCount > 1) {
+        int tableCount = static_cast<int>(shOpt->state->header.tableCount);
+        table = casino::table_of_player(id, tableCount);
+        seat = casino::seat_of_player(id, tableCount);
+        if (table != 0) {
+            casino::close_shared_memory(*shOpt);
+            shOpt = casino::open_shared_memory(false, {}, table);
+        }
+    }
+    if (shOpt) {
+        auto& sh = *shOpt;
+        if (static_cast<uint32_t>(seat) >= sh.state->header.capacity) {
+            std::cerr << "[player] invalid id (table " << table << " capacity " << sh.state->header.capacity << ")" << std::endl;
+            casino::close_shared_memory(sh);
+            return 1;
+        }
+        casino::ProfiledLock lock;
+        if (casino::profiled_lock(sh.state, casino::LOCK_SITE_PLAYER_PID, lock)) {
+            uint32_t seq = casino::publish_begin(sh.state);
+            casino::PlayerArrays players = casino::players_of(sh.state);
+            players.pid[seat] = static_cast<int32_t>(getpid());
+            casino::mark_seat_changed(sh.state, players, static_cast<uint32_t>(seat));
+            casino::publish_end(sh.state, seq);
+            casino::profiled_unlock(lock);
+            casino::notify_state_change(sh.state);
+        }
     }
 
-    sem_t* sem = sem_open(casino::SEM_NAME, 0);
-    bool semOk = sem != SEM_FAILED;
-    if (!semOk) {
-        std::cerr << "[player] sem_open failed (server semaphore not ready), continuing without\n";
+    auto senderOpt = casino::open_bet_sender(shOpt ? shOpt->state : nullptr, table);
+    if (!senderOpt) {
+        std::cerr << "[player] no bet channel (server not running?)" << std::endl;
+        if (shOpt) casino::close_shared_memory(*shOpt);
+        return 1;
     }
+    casino::BetSender sender = *senderOpt;
 
     std::mt19937 rng(static_cast<unsigned int>(std::chrono::steady_clock::now().time_since_epoch().count()) + id * 31);
     std::uniform_int_distribution<int> betDist(10, 120);
@@ -40,39 +71,37 @@ int main(int argc, char** argv) {
     std::uniform_int_distribution<int> pauseJitter(600, 1800);   // cadence variable par joueur
 
     // Décalage initial pour éviter que tous les joueurs envoient en même temps
-    int initialDelayMs = startJitter(rng) + id * 150;
+    int lane = id % casino::DEFAULT_PLAYERS;
+    int initialDelayMs = startJitter(rng) + lane * 150;
     std::this_thread::sleep_for(std::chrono::milliseconds(initialDelayMs));
 
     // Pause de base différente par joueur pour casser la synchro
-    int basePauseMs = 1200 + id * 320;
+    int basePauseMs = 1200 + lane * 320;
 
-    casino::BetMessage msg{};
-    msg.playerId = id;
+    casino::BetEntry bet{};
+    bet.playerId = seat; // seat index within our table
 
-    // Try to attach to shared memory and write our pid for diagnostics
-    auto shOpt = casino::open_shared_memory(false);
-    if (shOpt) {
-        auto sh = *shOpt;
-        if (sh.state) {
-            if (casino::safe_mutex_lock(&sh.state->mutex)) {
-                if (id >= 0 && id < casino::MAX_PLAYERS) sh.state->players[id].pid = static_cast<int32_t>(getpid());
-                pthread_mutex_unlock(&sh.state->mutex);
+    while (true) {
+        // the server holds a bet sent during our cooldown (and coalesces any
+        // more): sleep until the seat's published cooldown end instead
+        if (shOpt) {
+            const casino::PlayerSeat& mine = casino::players_of(static_cast<const casino::SharedState*>(shOpt->state)).seats[seat];
+            uint64_t readyNs = 0;
+            casino::read_consistent(shOpt->state, [&]() { readyNs = mine.nextAllowedNs; });
+            if (readyNs > casino::monotonic_ns()) {
+                std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(readyNs)));
             }
         }
-        casino::close_shared_memory(sh);
-    }
-
-    while (true) {
-        msg.amount = betDist(rng);
-        if (mq_send(mq, reinterpret_cast<const char*>(&msg), sizeof(msg), 0) != 0) {
-            std::cerr << "[player] mq_send failed" << std::endl;
-        } else if (semOk) {
-            sem_post(sem); // réveille le serveur si endormi sur le sémaphore
+        bet.amount = betDist(rng);
+        if (!casino::send_bet(sender, bet)) {
+            std::cerr << "[player] send failed ("
+                      << (sender.transport == casino::BET_TRANSPORT_RING ? "ring full" : "mq_send") << ")" << std::endl;
         }
         int pause = basePauseMs + pauseJitter(rng);
         std::this_thread::sleep_for(std::chrono::milliseconds(pause));
     }
 
-    mq_close(mq);
+    casino::close_bet_sender(sender);
+    if (shOpt) casino::close_shared_memory(*shOpt);
     return 0;
 }
@@ -0,0 +1,24 @@
+#include "player_tick.hpp"
+
+namespace casino {
+
+bool advance_players(float* __restrict spinProgress, float* __restrict pulse, int32_t* __restrict spinning,
+                     int count, float dProgress, float dPulse) {
+    int32_t active = 0;
+#pragma omp simd reduction(| : active)
+    for (int i = 0; i < count; ++i) {
+        // idle seats advance by 0 and already sit at 0 or 1, so the clamp is a no-op
+        float progressed = spinProgress[i] + dProgress * static_cast<float>(spinning[i]);
+        int32_t running = static_cast<int32_t>(progressed < 1.0f);
+        int32_t still = spinning[i] & running;
+        spinProgress[i] = running ? progressed : 1.0f;
+        spinning[i] = still;
+        float decayed = pulse[i] - dPulse;
+        int32_t glowing = static_cast<int32_t>(decayed > 0.0f);
+        pulse[i] = glowing ? decayed : 0.0f;
+        active |= still | glowing;
+    }
+    return active != 0;
+}
+
+} // namespace casino
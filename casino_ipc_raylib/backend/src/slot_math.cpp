@@ -0,0 +1,127 @@
+#include "slot_math.hpp"
+
+#include <limits>
+
+namespace casino {
+
+namespace {
+
+uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+inline uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+// One xoshiro256** round on every lane.
+void step(BatchRng& g, uint64_t* out) {
+    uint64_t* s0 = g.s[0];
+    uint64_t* s1 = g.s[1];
+    uint64_t* s2 = g.s[2];
+    uint64_t* s3 = g.s[3];
+#pragma omp simd
+    for (int l = 0; l < BATCH_RNG_LANES; ++l) {
+        out[l] = rotl(s1[l] * 5, 7) * 9;
+        uint64_t t = s1[l] << 17;
+        s2[l] ^= s0[l];
+        s3[l] ^= s1[l];
+        s1[l] ^= s2[l];
+        s0[l] ^= s3[l];
+        s2[l] ^= t;
+        s3[l] = rotl(s3[l], 45);
+    }
+}
+
+} // namespace
+
+void batch_rng_seed(BatchRng& rng, uint64_t seed) {
+    uint64_t x = seed;
+    for (int l = 0; l < BATCH_RNG_LANES; ++l) {
+        for (int w = 0; w < 4; ++w) rng.s[w][l] = splitmix64(x);
+    }
+    rng.next = BATCH_RNG_LANES;
+}
+
+void batch_rng_fill(BatchRng& rng, uint64_t* out, size_t n) {
+    size_t i = 0;
+    while (i < n && rng.next < BATCH_RNG_LANES) out[i++] = rng.buffered[rng.next++];
+    while (n - i >= static_cast<size_t>(BATCH_RNG_LANES)) {
+        step(rng, out + i);
+        i += BATCH_RNG_LANES;
+    }
+    if (i < n) {
+        step(rng, rng.buffered);
+        rng.next = 0;
+        while (i < n) out[i++] = rng.buffered[rng.next++];
+    }
+}
+
+bool build_alias_table(const uint32_t* weights, uint32_t count, AliasTable& out) {
+    if (count == 0 || count > 256) return false;
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < count; ++i) total += weights[i];
+    if (total == 0 || total > std::numeric_limits<uint32_t>::max()) return false;
+
+    // Vose in integers: column i holds weight * count against an average of total
+    std::vector<uint64_t> scaled(count);
+    std::vector<uint32_t> small, large;
+    for (uint32_t i = 0; i < count; ++i) {
+        scaled[i] = static_cast<uint64_t>(weights[i]) * count;
+        (scaled[i] < total ? small : large).push_back(i);
+    }
+    out.size = count;
+    out.threshold.assign(count, std::numeric_limits<uint32_t>::max());
+    out.alias.resize(count);
+    for (uint32_t i = 0; i < count; ++i) out.alias[i] = static_cast<uint8_t>(i);
+    while (!small.empty() && !large.empty()) {
+        uint32_t s = small.back();
+        small.pop_back();
+        uint32_t l = large.back();
+        // scaled[s] < total < 2^32, so the shift cannot overflow
+        out.threshold[s] = static_cast<uint32_t>((scaled[s] << 32) / total);
+        out.alias[s] = static_cast<uint8_t>(l);
+        scaled[l] -= total - scaled[s];
+        if (scaled[l] < total) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // leftovers are full columns (threshold max, alias to themselves)
+    return true;
+}
+
+uint8_t sample_alias(const AliasTable& table, BatchRng& retry, uint64_t random) {
+    uint64_t m = (random >> 32) * table.size;
+    if (static_cast<uint32_t>(m) < table.size) {
+        uint32_t floor = (0u - table.size) % table.size;
+        while (static_cast<uint32_t>(m) < floor) {
+            uint64_t redraw = 0;
+            batch_rng_fill(retry, &redraw, 1);
+            m = (redraw >> 32) * table.size;
+        }
+    }
+    uint32_t column = static_cast<uint32_t>(m >> 32);
+    return static_cast<uint32_t>(random) < table.threshold[column] ? static_cast<uint8_t>(column) : table.alias[column];
+}
+
+void reel_sampler_init(ReelSampler& sampler, uint64_t seed) {
+    for (auto& reel : sampler.reels) build_alias_table(SYMBOL_WEIGHTS, SYMBOL_COUNT, reel);
+    batch_rng_seed(sampler.rng, seed);
+    batch_rng_seed(sampler.retry, ~seed);
+}
+
+void draw_stops(ReelSampler& sampler, uint8_t* stops, size_t spins) {
+    const size_t n = spins * REEL_COUNT;
+    if (sampler.scratch.size() < n) sampler.scratch.resize(n);
+    batch_rng_fill(sampler.rng, sampler.scratch.data(), n);
+    const uint64_t* r = sampler.scratch.data();
+    for (size_t i = 0; i < spins; ++i) {
+        for (int reel = 0; reel < REEL_COUNT; ++reel) {
+            stops[i * REEL_COUNT + reel] = sample_alias(sampler.reels[reel], sampler.retry, r[i * REEL_COUNT + reel]);
+        }
+    }
+}
+
+} // namespace casino
@@ -0,0 +1,339 @@
+#include "table_engine.hpp"
+#include "bet_ring.hpp"
+#include "event_ring.hpp"
+#include "ipc_shared.hpp"
+#include "lock_profile.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace casino {
+
+namespace {
+
+struct TargetPos {
+    float x = 0.0f;
+    float y = 0.0f;
+    std::chrono::steady_clock::time_point nextChange;
+};
+
+bool load_layout(const std::string& path, std::vector<TargetPos>& out, int playerCount) {
+    std::ifstream f(path);
+    if (!f.is_open()) return false;
+    int idx = 0;
+    std::string tag;
+    while (f >> tag) {
+        if (tag == "P") {
+            float x, y;
+            if (!(f >> x >> y)) break;
+            if (idx < playerCount && idx < (int)out.size()) {
+                out[idx].x = x;
+                out[idx].y = y;
+            }
+            idx++;
+        } else if (tag == "S") {
+            // skip scale line
+            std::string rest;
+            std::getline(f, rest);
+        }
+    }
+    return true;
+}
+
+// Histogram bucket for a batch of n >= 1 spins: floor(log2 n), last bucket open-ended.
+int batch_bucket(size_t n) {
+    int b = 0;
+    while ((n >> (b + 1)) != 0 && b < BATCH_HIST_BUCKETS - 1) ++b;
+    return b;
+}
+
+// Seat positions: a circle around the table, overridden by layout.txt if present.
+std::vector<TargetPos> seat_positions(int playerCount) {
+    std::vector<TargetPos> targets(playerCount);
+    const float cx = 960.0f;
+    const float cy = 540.0f + 60.0f;
+    const float radius = 300.0f;
+    for (int i = 0; i < playerCount; ++i) {
+        float angle = 3.14159f / 2 + (6.28318f * i / std::max(6, playerCount));
+        targets[i].x = cx + radius * std::cos(angle);
+        targets[i].y = cy + radius * std::sin(angle);
+    }
+    // Load layout.txt if present to override positions
+    if (!load_layout("viewer/layout.txt", targets, playerCount)) {
+        load_layout("layout.txt", targets, playerCount);
+    }
+    return targets;
+}
+
+// Fills the server stages of a bet's trace. A bet sent while the loop was
+// still busy queued until that iteration ended; the rest, up to the wakeup,
+// is the wakeup itself.
+void trace_spin(SpinEvent& ev, const BetMessage& msg, LoopStamps loop, uint64_t lockNs,
+                uint64_t publishedNs) {
+    auto span = [](uint64_t from, uint64_t to) {
+        return static_cast<uint32_t>(std::min<uint64_t>(to > from ? to - from : 0, UINT32_MAX));
+    };
+    const uint64_t freeNs = std::max(msg.sentNs, loop.idleNs);
+    ev.betIndex = msg.index;
+    ev.betSender = msg.sender;
+    ev.betSeq = msg.seq;
+    ev.sentNs = msg.sentNs;
+    ev.publishedNs = publishedNs;
+    ev.stageNs[TRACE_QUEUE] = span(msg.sentNs, freeNs);
+    ev.stageNs[TRACE_WAKEUP] = span(freeNs, loop.wakeNs);
+    ev.stageNs[TRACE_ROLL] = span(loop.wakeNs, lockNs);
+    ev.stageNs[TRACE_LOCK] = span(lockNs, publishedNs);
+}
+
+} // namespace
+
+void TableEngine::init(SharedState* s, const EngineConfig& cfg, int index, int seats,
+                       std::chrono::steady_clock::time_point start, bool adopted) {
+    state = s;
+    players = players_of(s);
+    playerCount = seats;
+    randomStarts = cfg.randomStarts;
+    betTtl = std::chrono::milliseconds(cfg.betTtlMs);
+    // table 0 keeps the historical seed so single-table runs replay unchanged
+    rng.seed(cfg.seed + static_cast<unsigned int>(index) * 0x9E3779B9u);
+
+    timers.assign(playerCount, SpinTimers{});
+    constexpr float MIN_COOLDOWN = 2.2f;
+    std::uniform_int_distribution<int> initialJitter(0, 800);
+    for (int i = 0; i < playerCount; ++i) {
+        // stagger pattern repeats every DEFAULT_PLAYERS seats so large tables keep sane cooldowns
+        int lane = i % DEFAULT_PLAYERS;
+        timers[i].nextAllowed = start + std::chrono::milliseconds(200 * lane + initialJitter(rng));
+        timers[i].cooldownMin = MIN_COOLDOWN + (lane * 0.1f);
+        timers[i].cooldownMax = 4.5f + (lane * 0.2f);
+        timers[i].nextRandomStart = start + std::chrono::milliseconds(randomStart(rng));
+    }
+    waitingSeats = 0;
+
+    std::vector<TargetPos> targets = seat_positions(playerCount);
+    ProfiledLock lock;
+    if (!profiled_lock(state, LOCK_SITE_SERVER_INIT, lock)) {
+        std::cerr << "[server] failed to lock mutex during init\n";
+    }
+    uint32_t initSeq = publish_begin(state);
+    state->header.betTransport = cfg.transport;
+    state->playerCount = playerCount;
+    if (!adopted) state->jackpot = 1200; // banque initiale: doubled from 600
+    deferred = adopted ? state->bet_deferred : 0;
+    coalesced = adopted ? state->bet_coalesced : 0;
+    expired = adopted ? state->bet_expired : 0;
+    for (int i = 0; i < playerCount; ++i) {
+        players.seats[i].id = i * cfg.tables + index; // global player id
+        players.seats[i].x = targets[i].x;
+        players.seats[i].y = targets[i].y;
+        players.seats[i].nextAllowedNs = monotonic_stamp(timers[i].nextAllowed);
+        players.spinStartNs[i] = 0;
+        players.pulseStartNs[i] = 0;
+        mark_seat_changed(state, players, static_cast<uint32_t>(i));
+        if (adopted) continue; // players attached to the file keep their pid
+        players.seats[i].animState = ANIM_IDLE;
+        players.pulsePeak[i] = 0.0f;
+        players.pid[i] = -1;
+    }
+    publish_end(state, initSeq);
+    profiled_unlock(lock);
+    if (wakeReaders) notify_state_change(state);
+
+    originNs = monotonic_stamp(start);
+
+    // Reel stops come from a per-table xoshiro stream through the alias tables,
+    // drawn STOP_BATCH spins at a time; the sequence depends only on the seed.
+    reel_sampler_init(reels, (static_cast<uint64_t>(cfg.seed) << 8) | static_cast<uint64_t>(index));
+    stops.assign(STOP_BATCH * REEL_COUNT, 0);
+    nextStop = STOP_BATCH;
+    batch.reserve(bet_ring_of(state)->slots);
+}
+
+SpinOutcome TableEngine::roll_spin(int playerId) {
+    if (nextStop == STOP_BATCH) {
+        draw_stops(reels, stops.data(), STOP_BATCH);
+        nextStop = 0;
+    }
+    const uint8_t* reel = &stops[nextStop++ * REEL_COUNT];
+    SpinOutcome o{};
+    o.playerId = playerId;
+    o.symbols[0] = reel[0];
+    o.symbols[1] = reel[1];
+    o.symbols[2] = reel[2];
+    o.payout = spin_payout(reel);
+    o.win = o.payout > 0;
+    o.delta = o.payout - SPIN_COST;
+    return o;
+}
+
+std::chrono::steady_clock::time_point TableEngine::next_deadline() const {
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    if (!randomStarts && waitingSeats == 0) return deadline;
+    for (int pid = 0; pid < playerCount; ++pid) {
+        const SpinTimers& t = timers[pid];
+        if (t.waiting()) deadline = std::min(deadline, t.nextAllowed);
+        if (randomStarts) deadline = std::min(deadline, std::max(t.nextRandomStart, t.nextAllowed));
+    }
+    return deadline;
+}
+
+void TableEngine::start_spin(int pid, std::chrono::steady_clock::time_point now) {
+    SpinTimers& t = timers[pid];
+    float cd = std::uniform_real_distribution<float>(t.cooldownMin, t.cooldownMax)(rng);
+    t.nextAllowed = now + std::chrono::milliseconds((int)(cd * 1000));
+    batch.push_back(roll_spin(pid));
+}
+
+bool TableEngine::roll(std::chrono::steady_clock::time_point now, const std::vector<BetMessage>& bets, bool timerFired) {
+    batch.clear();
+    verdicts.clear();
+    const uint64_t expiredBefore = expired;
+    // held bets arrived before anything drained now: they spin first
+    for (int pid = 0; waitingSeats > 0 && pid < playerCount; ++pid) {
+        SpinTimers& t = timers[pid];
+        if (!t.waiting() || now < t.nextAllowed) continue;
+        if (t.pending) {
+            t.pending = false;
+            if (betTtl.count() > 0 && now - t.pendingSince > betTtl) {
+                expired++;
+            } else {
+                start_spin(pid, now);
+            }
+        }
+        if (now >= t.nextAllowed && t.autoplay > 0) {
+            t.autoplay--;
+            start_spin(pid, now);
+        }
+        if (!t.waiting()) waitingSeats--;
+    }
+    for (size_t b = 0; b < bets.size(); ++b) {
+        const BetMessage& msg = bets[b];
+        int pid = msg.playerId;
+        if (pid < 0 || pid >= playerCount || msg.spins < 0) {
+            verdicts.push_back(BET_INVALID);
+            continue;
+        }
+        SpinTimers& t = timers[pid];
+        const bool wasWaiting = t.waiting();
+        if (msg.spins != 1) {
+            // autoplay: the first spin starts now if the seat may spin
+            t.autoplay = msg.spins;
+            const bool startNow = t.autoplay > 0 && now >= t.nextAllowed;
+            if (startNow) {
+                t.autoplay--;
+                start_spin(pid, now);
+                batch.back().bet = static_cast<int>(b);
+            }
+            verdicts.push_back(startNow || msg.spins == 0 ? BET_ACCEPTED : BET_COOLDOWN);
+        } else if (now >= t.nextAllowed) {
+            start_spin(pid, now);
+            batch.back().bet = static_cast<int>(b);
+            verdicts.push_back(BET_ACCEPTED);
+        } else {
+            if (t.pending) {
+                coalesced++;
+            } else {
+                t.pending = true;
+                deferred++;
+            }
+            t.pendingSince = now;
+            verdicts.push_back(BET_COOLDOWN);
+        }
+        waitingSeats += (t.waiting() ? 1 : 0) - (wasWaiting ? 1 : 0);
+    }
+    betSpins = batch.size();
+
+    // Lancer des spins aléatoires même sans message, pour désynchroniser encore plus
+    if (randomStarts) {
+        for (int pid = 0; pid < playerCount; ++pid) {
+            auto& t = timers[pid];
+            if (now >= t.nextRandomStart && now >= t.nextAllowed) {
+                start_spin(pid, now);
+                t.nextRandomStart = now + std::chrono::milliseconds(randomStart(rng));
+            }
+        }
+    }
+
+    // Nothing to publish: no spin started and bets were all held by cooldowns
+    return !(batch.empty() && !timerFired && expired == expiredBefore);
+}
+
+void TableEngine::commit(std::chrono::steady_clock::time_point now, TickSample sample, const std::vector<BetMessage>* bets,
+                         LoopStamps loop) {
+    const uint64_t lockNs = monotonic_ns();
+    const uint64_t startNs = monotonic_stamp(now);
+    ProfiledLock lock;
+    const LockSite site = batch.empty() ? LOCK_SITE_SERVER_TICK : LOCK_SITE_SERVER_SPINS;
+    if (!profiled_lock(state, site, lock)) {
+        std::cerr << "[server] failed to lock mutex for commit\n";
+    }
+    uint32_t seq = publish_begin(state);
+    state->mutex_held = 1;
+    state->mutex_last_held_ts = sample.wallMs;
+    state->tick++;
+    for (auto& o : batch) {
+        state->tick++;
+        o.tick = state->tick;
+        state->rounds++;
+        state->jackpot += o.delta;
+        if (state->jackpot < 0) state->jackpot = 0;
+        auto& p = players.seats[o.playerId];
+        p.symbols[0] = o.symbols[0];
+        p.symbols[1] = o.symbols[1];
+        p.symbols[2] = o.symbols[2];
+        p.lastDelta = o.delta;
+        p.lastPayout = o.payout;
+        p.nextAllowedNs = monotonic_stamp(timers[o.playerId].nextAllowed);
+        p.animState = o.win ? ANIM_WIN : ANIM_LOSE;
+        players.spinStartNs[o.playerId] = startNs;
+        players.pulseStartNs[o.playerId] = startNs;
+        players.pulsePeak[o.playerId] = o.win ? 1.0f : 0.3f;
+        mark_seat_changed(state, players, static_cast<uint32_t>(o.playerId));
+        state->lastWinnerId = o.win ? p.id : -1; // global player id, as the SpinEvent
+        state->lastWinAmount = o.payout;
+    }
+    if (!batch.empty()) {
+        state->batch_commits++;
+        state->batch_hist[batch_bucket(batch.size())]++;
+        state->batch_max = std::max<uint32_t>(state->batch_max, static_cast<uint32_t>(batch.size()));
+    }
+    // update instrumentation: bet queue depth/overflows + producer wakeups
+    state->bet_depth = sample.betDepth;
+    state->bet_overflows = sample.betOverflows;
+    state->bet_wakeups = sample.betWakeups;
+    state->bet_abandoned = sample.betAbandoned;
+    state->bet_frames = sample.betFrames;
+    state->bet_seq_gaps = sample.betSeqGaps;
+    state->bet_seq_dups = sample.betSeqDups;
+    state->bet_bad_frames = sample.betBadFrames;
+    state->bet_deferred = deferred;
+    state->bet_coalesced = coalesced;
+    state->bet_expired = expired;
+    state->mutex_held = 0;
+    publish_end(state, seq);
+    profiled_unlock(lock);
+    const uint64_t publishedNs = monotonic_ns();
+
+    EventRing* events = event_ring_of(state);
+    for (const auto& o : batch) {
+        SpinEvent ev{};
+        ev.playerId = players.seats[o.playerId].id;
+        ev.seat = o.playerId;
+        ev.symbols[0] = o.symbols[0];
+        ev.symbols[1] = o.symbols[1];
+        ev.symbols[2] = o.symbols[2];
+        ev.delta = o.delta;
+        ev.payout = o.payout;
+        ev.tick = o.tick;
+        ev.timestampNs = startNs;
+        if (bets && o.bet >= 0 && (*bets)[o.bet].sentNs != 0) trace_spin(ev, (*bets)[o.bet], loop, lockNs, publishedNs);
+        event_ring_publish(events, ev);
+    }
+    // seats and events are visible: wake the readers waiting for a change
+    if (wakeReaders) notify_state_change(state);
+}
+
+} // namespace casino
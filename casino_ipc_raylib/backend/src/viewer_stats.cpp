@@ -0,0 +1,131 @@
+#include "viewer_stats.hpp"
+#include "latency_hist.hpp"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <iostream>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace casino {
+
+namespace {
+
+std::string own_name() { return VIEWER_STATS_PREFIX + std::to_string(getpid()); }
+
+bool process_alive(pid_t pid) { return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM); }
+
+} // namespace
+
+ViewerStats* viewer_stats_create(int table) {
+    std::string name = own_name();
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0666);
+    if (fd < 0) {
+        std::cerr << "[viewer] stats shm_open failed: " << std::strerror(errno) << "\n";
+        return nullptr;
+    }
+    void* addr = MAP_FAILED;
+    if (ftruncate(fd, sizeof(ViewerStats)) == 0) {
+        addr = mmap(nullptr, sizeof(ViewerStats), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (addr == MAP_FAILED) {
+        std::cerr << "[viewer] stats segment failed: " << std::strerror(errno) << "\n";
+        shm_unlink(name.c_str());
+        return nullptr;
+    }
+    auto* stats = new (addr) ViewerStats();
+    stats->version = VIEWER_STATS_VERSION;
+    stats->pid = static_cast<int32_t>(getpid());
+    stats->table = table;
+    stats->magic.store(VIEWER_STATS_MAGIC, std::memory_order_release);
+    return stats;
+}
+
+void viewer_stats_destroy(ViewerStats* stats) {
+    if (!stats) return;
+    munmap(stats, sizeof(ViewerStats));
+    shm_unlink(own_name().c_str());
+}
+
+void viewer_stats_frame(ViewerStats* stats, uint64_t frameNs, const ViewerFrameCounters& c) {
+    if (!stats) return;
+    latency_record(stats->frameTime, frameNs);
+    stats->attached.store(c.attached ? 1 : 0, std::memory_order_relaxed);
+    stats->seqlockReads.store(c.seqlockReads, std::memory_order_relaxed);
+    stats->seqlockRetries.store(c.seqlockRetries, std::memory_order_relaxed);
+    stats->slowReads.store(c.slowReads, std::memory_order_relaxed);
+    stats->eventsRead.store(c.eventsRead, std::memory_order_relaxed);
+    stats->eventsLost.store(c.eventsLost, std::memory_order_relaxed);
+    stats->frames.store(stats->frames.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void viewer_stats_trace(ViewerStats* stats, const SpinEvent& ev, uint64_t polledNs, uint64_t presentedNs) {
+    if (!stats || ev.betIndex < 0 || ev.sentNs == 0) return;
+    for (int stage = 0; stage < TRACE_SERVER_STAGES; ++stage) latency_record(stats->trace[stage], ev.stageNs[stage]);
+    latency_record(stats->trace[TRACE_POLL], polledNs > ev.publishedNs ? polledNs - ev.publishedNs : 0);
+    latency_record(stats->trace[TRACE_PRESENT], presentedNs > polledNs ? presentedNs - polledNs : 0);
+    latency_record(stats->trace[TRACE_TOTAL], presentedNs > ev.sentNs ? presentedNs - ev.sentNs : 0);
+    stats->tracedSpins.store(stats->tracedSpins.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+const char* trace_stage_name(int stage) {
+    switch (stage) {
+    case TRACE_QUEUE: return "queue";
+    case TRACE_WAKEUP: return "wakeup";
+    case TRACE_ROLL: return "roll";
+    case TRACE_LOCK: return "lock";
+    case TRACE_POLL: return "poll";
+    case TRACE_PRESENT: return "present";
+    case TRACE_TOTAL: return "total";
+    default: return "?";
+    }
+}
+
+std::vector<ViewerStatsView> viewer_stats_open_all() {
+    std::vector<ViewerStatsView> views;
+    // POSIX shm names live in /dev/shm on Linux, without the leading '/'
+    DIR* dir = opendir("/dev/shm");
+    if (!dir) return views;
+    const std::string prefix = VIEWER_STATS_PREFIX + 1;
+    while (dirent* entry = readdir(dir)) {
+        if (std::strncmp(entry->d_name, prefix.c_str(), prefix.size()) != 0) continue;
+        std::string name = std::string("/") + entry->d_name;
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) continue;
+        struct stat st{};
+        void* addr = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(ViewerStats)) {
+            addr = mmap(nullptr, sizeof(ViewerStats), PROT_READ, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (addr == MAP_FAILED) continue;
+        const auto* stats = static_cast<const ViewerStats*>(addr);
+        bool ready = stats->magic.load(std::memory_order_acquire) == VIEWER_STATS_MAGIC &&
+                     stats->version == VIEWER_STATS_VERSION;
+        if (ready && !process_alive(stats->pid)) {
+            // viewer crashed without cleaning up
+            shm_unlink(name.c_str());
+            ready = false;
+        }
+        if (!ready) {
+            munmap(addr, sizeof(ViewerStats));
+            continue;
+        }
+        views.push_back({name, stats, sizeof(ViewerStats)});
+    }
+    closedir(dir);
+    return views;
+}
+
+void viewer_stats_close_all(std::vector<ViewerStatsView>& views) {
+    for (auto& v : views) munmap(const_cast<ViewerStats*>(v.stats), v.size);
+    views.clear();
+}
+
+} // namespace casino
@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+"""Compare deux fichiers de résultats de microbenchmarks (bench_hot --json,
+bench_viewer --json).
+
+Les cas sont appariés par nom ; pour chacun on affiche les médianes (ns/op),
+leur rapport et le p99. Un cas dont la médiane augmente de plus de --threshold
+pour cent compte comme une régression et le script sort avec le code 1.
+
+Les mesures dépendent de la fréquence CPU : un avertissement est affiché si les
+deux fichiers ne viennent pas du même hôte, gouverneur ou compilateur.
+
+    scripts/bench_compare.py BASE.json NEW.json [--threshold 5]
+"""
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    if data.get("format") != 1:
+        sys.exit(f"{path}: format de résultats inconnu ({data.get('format')})")
+    return data
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("base")
+    ap.add_argument("new")
+    ap.add_argument("--threshold", type=float, default=5.0, help="régression tolérée sur la médiane, en %%")
+    args = ap.parse_args()
+
+    base, new = load(args.base), load(args.new)
+    if base.get("suite") != new.get("suite"):
+        print(f"attention : suites différentes ({base.get('suite')} / {new.get('suite')})")
+    for key in ("cpus", "governor", "compiler"):
+        b, n = base["host"].get(key), new["host"].get(key)
+        if b != n:
+            print(f"attention : {key} différent ({b} / {n}), comparaison peu fiable")
+    if base["host"].get("governor") != "performance":
+        print("attention : fréquence CPU non fixée (gouverneur "
+              f"{base['host'].get('governor')}), prévoir quelques % de bruit")
+
+    old = {r["name"]: r for r in base["results"]}
+    regressions = 0
+    print(f"{'cas':<40} {'base ns':>10} {'new ns':>10} {'ratio':>8} {'p99 base':>10} {'p99 new':>10}")
+    for r in new["results"]:
+        b = old.pop(r["name"], None)
+        if b is None:
+            print(f"{r['name']:<40} {'-':>10} {r['median']:>10.2f} {'nouveau':>8}")
+            continue
+        ratio = r["median"] / b["median"] if b["median"] > 0 else float("inf")
+        flag = ""
+        if (ratio - 1.0) * 100.0 > args.threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        elif (1.0 - ratio) * 100.0 > args.threshold:
+            flag = "  mieux"
+        print(f"{r['name']:<40} {b['median']:>10.2f} {r['median']:>10.2f} {ratio:>7.3f}x "
+              f"{b['p99']:>10.2f} {r['p99']:>10.2f}{flag}")
+    for name in old:
+        print(f"{name:<40} absent des nouveaux résultats")
+
+    print(f"{regressions} régression(s) au-delà de {args.threshold:g} %")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -4,10 +4,21 @@ set -euo pipefail
 # Uses libc shm_unlink/mq_unlink/sem_unlink via Python+ctypes to avoid extra deps.
 python3 - <<'PY'
 import ctypes
+import os
 import sys
 libc = ctypes.CDLL('libc.so.6')
 for name, func in {'shm_unlink': libc.shm_unlink, 'mq_unlink': libc.mq_unlink, 'sem_unlink': libc.sem_unlink}.items():
-    for target in (b'/casino_ipc_shared', b'/casino_ipc_mq', b'/casino_ipc_sem'):
+    targets = [b'/casino_ipc_shared', b'/casino_ipc_mq', b'/casino_ipc_sem']
+    # per-table names of `casino_server --tables N` (table t > 0 appends .t<t>)
+    if name != 'sem_unlink':
+        targets += [base + b'.t%d' % t for base in (b'/casino_ipc_shared', b'/casino_ipc_mq') for t in range(1, 64)]
+    # frame statistics of viewers (/casino_viewer.<pid>) that did not exit cleanly
+    if name == 'shm_unlink':
+        try:
+            targets += [b'/' + f.encode() for f in os.listdir('/dev/shm') if f.startswith('casino_viewer.')]
+        except OSError:
+            pass
+    for target in targets:
         res = func(target)
         if res != 0:
             # errno set; ignore if not present
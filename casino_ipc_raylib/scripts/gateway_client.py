@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""Client de test de casino_gateway, sur localhost.
+
+Ouvre --idle connexions qui ne font rien (tenue en charge), puis une connexion
+active qui mise pour --players joueurs pendant --seconds secondes et compte
+les acquittements et résultats reçus.
+
+    scripts/gateway_client.py [--connect HOST:PORT | --unix PATH] [--idle N]
+                              [--players 0,1,2] [--rounds N] [--seconds S]
+"""
+import argparse
+import resource
+import select
+import socket
+import struct
+import sys
+import time
+
+VERSION = 1
+GW_BETS, GW_ACK, GW_RESULT, GW_ERROR = 1, 2, 3, 4
+HEADER = struct.Struct("<BBH")
+BET = struct.Struct("<iii")
+ACK = struct.Struct("<II")
+RESULT = struct.Struct("<iiiiiiIIQ")
+
+
+def connect(args):
+    if args.unix:
+        s = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        s.connect(args.unix)
+    else:
+        host, _, port = args.connect.rpartition(":")
+        s = socket.create_connection((host or "127.0.0.1", int(port)))
+    return s
+
+
+def bets_message(players, amount=50, spins=1):
+    body = b"".join(BET.pack(p, amount, spins) for p in players)
+    return HEADER.pack(VERSION, GW_BETS, len(players)) + body
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--connect", default="127.0.0.1:9470")
+    ap.add_argument("--unix")
+    ap.add_argument("--idle", type=int, default=0)
+    ap.add_argument("--players", default="0")
+    ap.add_argument("--rounds", type=int, default=3, help="mises par joueur")
+    ap.add_argument("--seconds", type=float, default=8.0)
+    args = ap.parse_args()
+
+    soft, hard = resource.getrlimit(resource.RLIMIT_NOFILE)
+    resource.setrlimit(resource.RLIMIT_NOFILE, (min(hard, max(soft, args.idle + 64)), hard))
+
+    start = time.monotonic()
+    idle = []
+    for i in range(args.idle):
+        idle.append(connect(args))
+    print(f"[client] {len(idle)} connexions inactives ouvertes en {time.monotonic() - start:.2f} s")
+
+    players = [int(p) for p in args.players.split(",") if p]
+    s = connect(args)
+    s.setblocking(False)
+    poller = select.poll()  # select() ne dépasse pas le fd 1023
+    poller.register(s, select.POLLIN)
+    forwarded = refused = results = 0
+    buf = b""
+    sent_rounds = 0
+    next_bet = time.monotonic()
+    deadline = time.monotonic() + args.seconds
+    while time.monotonic() < deadline:
+        now = time.monotonic()
+        if sent_rounds < args.rounds and now >= next_bet:
+            s.sendall(bets_message(players))
+            sent_rounds += 1
+            next_bet = now + 1.0  # le serveur retient les mises du cooldown
+        if not poller.poll(50):
+            continue
+        chunk = s.recv(65536)
+        if not chunk:
+            print("[client] connexion fermée par la passerelle")
+            break
+        buf += chunk
+        while len(buf) >= HEADER.size:
+            version, kind, count = HEADER.unpack_from(buf)
+            size = {GW_ACK: ACK.size, GW_RESULT: RESULT.size * count}.get(kind, 0)
+            if len(buf) < HEADER.size + size:
+                break
+            body = buf[HEADER.size:HEADER.size + size]
+            buf = buf[HEADER.size + size:]
+            if kind == GW_ACK:
+                f, rf = ACK.unpack(body)
+                forwarded += f
+                refused += rf
+            elif kind == GW_RESULT:
+                for k in range(count):
+                    pid, delta, payout, a, b, c, table, _, tick = RESULT.unpack_from(body, k * RESULT.size)
+                    results += 1
+                    print(f"[client] joueur {pid} table {table} tick {tick}: [{a} {b} {c}] gain {payout} ({delta:+d})")
+            elif kind == GW_ERROR:
+                print(f"[client] erreur {count} de la passerelle")
+                return 1
+        if sent_rounds == args.rounds and results >= forwarded and forwarded + refused == args.rounds * len(players):
+            break
+
+    alive = 0
+    for c in idle:
+        c.setblocking(False)
+        try:
+            alive += c.recv(1) != b""
+        except BlockingIOError:
+            alive += 1
+    print(f"[client] mises: {forwarded} transmises, {refused} refusées; {results} résultats; "
+          f"{alive}/{len(idle)} connexions inactives toujours ouvertes")
+    return 0 if results > 0 or not players else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,210 @@
+// Per-frame viewer work, timed with backend/bench/bench_harness.hpp:
+// copy_snapshot (full copy, nothing changed, one seat changed, and against a
+// writer thread publishing as fast as it can), update_scene, bitmap label layout, and the scene.json / Tiled .tmj
+// loaders on generated files with many slots. Needs no window: nothing drawn.
+//
+//   bench_viewer [--warmup N] [--reps N] [--min-rep-ms MS] [--json FILE] [--filter TEXT]
+#include "bench_harness.hpp"
+#include "anim.hpp"
+#include "ipc_attach.hpp"
+#include "ipc_shared.hpp"
+#include "layout_config.hpp"
+#include "render.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// Anonymous shared mapping initialised like a server segment, seats filled.
+casino::SharedState* make_segment(uint32_t capacity, size_t& size) {
+    casino::SegmentConfig cfg;
+    cfg.capacity = capacity;
+    casino::SegmentLayout layout{};
+    if (!casino::compute_layout(cfg, layout)) return nullptr;
+    size = layout.segmentSize;
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED) return nullptr;
+    auto* state = static_cast<casino::SharedState*>(addr);
+    if (!casino::initialize_state(state, cfg)) {
+        munmap(addr, size);
+        return nullptr;
+    }
+    casino::PlayerArrays players = casino::players_of(state);
+    for (uint32_t i = 0; i < capacity; ++i) {
+        players.seats[i].id = static_cast<int32_t>(i);
+        players.seats[i].x = 100.0f + (i % 16) * 60.0f;
+        players.seats[i].y = 200.0f + (i / 16) * 40.0f;
+    }
+    state->playerCount = static_cast<int32_t>(capacity);
+    return state;
+}
+
+std::string write_temp(const std::string& content) {
+    char path[] = "/tmp/bench_viewer_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) return {};
+    close(fd);
+    std::ofstream(path) << content;
+    return path;
+}
+
+std::string scene_json(int slots) {
+    std::string s = "{\n  \"ui\": {\"slotScale\": 1.0, \"symbolScale\": 1.0, \"playerScale\": 1.0, \"windowW\": 16.0, "
+                    "\"windowH\": 16.0, \"windowOffsetX\": 68.0, \"windowOffsetY\": 96.0, \"panelScale\": 1.0},\n  \"slots\": [\n";
+    for (int i = 0; i < slots; ++i) {
+        s += "    {\"id\": " + std::to_string(i) + ", \"x\": " + std::to_string(100 + i % 32 * 50) + ".0, \"y\": " +
+             std::to_string(100 + i / 32 * 40) + ".0, \"slotScale\": 1.0, \"symbolScale\": 1.0, \"playerScale\": 1.0, "
+             "\"windowW\": 16.0, \"windowH\": 16.0, \"windowOffsetX\": 68.0, \"windowOffsetY\": 96.0}";
+        s += i + 1 < slots ? ",\n" : "\n";
+    }
+    return s + "  ]\n}\n";
+}
+
+std::string tiled_tmj(int slots) {
+    std::string s = "{\"height\":68,\"width\":120,\"properties\":[{\"name\":\"panelScale\",\"type\":\"float\",\"value\":1.0},"
+                    "{\"name\":\"slotScale\",\"type\":\"float\",\"value\":1.0}],\"layers\":[{\"name\":\"slots\",\"objects\":[";
+    for (int i = 0; i < slots; ++i) {
+        s += "{\"id\":" + std::to_string(i + 1) + ",\"name\":\"slot\",\"type\":\"slot\",\"x\":" +
+             std::to_string(100 + i % 32 * 50) + ",\"y\":" + std::to_string(100 + i / 32 * 40) + "}";
+        if (i + 1 < slots) s += ",";
+    }
+    return s + "],\"type\":\"objectgroup\"}]}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::Options opt;
+    for (int i = 1; i < argc; ++i) {
+        if (!bench::parse_option(opt, i, argc, argv)) {
+            std::fprintf(stderr, "Usage: bench_viewer %s\n", bench::USAGE);
+            return 1;
+        }
+    }
+    bench::Suite suite("bench_viewer", opt);
+
+    for (uint32_t capacity : {16u, 1024u}) {
+        size_t size = 0;
+        casino::SharedState* state = make_segment(capacity, size);
+        if (!state) {
+            std::fprintf(stderr, "bench_viewer: cannot build a segment\n");
+            return 1;
+        }
+        SharedAttachment att{};
+        att.state = state;
+        att.size = size;
+        att.valid = true;
+        att.events = casino::event_cursor_at_head(casino::event_ring_of(state));
+        CasinoSnap snap;
+        const std::string seats = std::to_string(capacity);
+        suite.run("copy_snapshot/" + seats + "_seats/full", 1, [&]() {
+            att.synced = false; // as right after an attach
+            bench::keep(copy_snapshot(att, snap));
+        });
+        suite.run("copy_snapshot/" + seats + "_seats/unchanged", 1, [&]() { bench::keep(copy_snapshot(att, snap)); });
+        casino::PlayerArrays seatArrays = casino::players_of(state);
+        uint32_t next = 0;
+        suite.run("copy_snapshot/" + seats + "_seats/1_changed", 1, [&]() {
+            // one spin landing between two frames (the publish is part of the timing)
+            uint32_t seq = casino::publish_begin(state);
+            const uint32_t seat = next++ % capacity;
+            seatArrays.seats[seat].lastDelta = static_cast<int32_t>(next);
+            casino::mark_seat_changed(state, seatArrays, seat);
+            casino::publish_end(state, seq);
+            bench::keep(copy_snapshot(att, snap));
+        });
+
+        // a table thread committing continuously: reads now retry
+        std::atomic<bool> stop{false};
+        std::thread writer([&]() {
+            casino::PlayerArrays players = casino::players_of(state);
+            casino::EventRing* events = casino::event_ring_of(state);
+            casino::SpinEvent ev{};
+            for (uint32_t k = 0; !stop.load(std::memory_order_relaxed); ++k) {
+                uint32_t seq = casino::publish_begin(state);
+                state->tick++;
+                players.seats[k % capacity].lastDelta = static_cast<int32_t>(k);
+                players.spinStartNs[k % capacity] = casino::monotonic_ns();
+                casino::mark_seat_changed(state, players, k % capacity);
+                casino::publish_end(state, seq);
+                ev.seat = static_cast<int32_t>(k % capacity);
+                ev.tick = state->tick;
+                casino::event_ring_publish(events, ev);
+            }
+        });
+        uint64_t retriesBefore = att.retries;
+        uint64_t readsBefore = att.reads;
+        suite.run("copy_snapshot/" + seats + "_seats/contended", 1, [&]() { bench::keep(copy_snapshot(att, snap)); });
+        stop.store(true);
+        writer.join();
+        std::printf("  (%.2f seqlock retries per contended read)\n",
+                    static_cast<double>(att.retries - retriesBefore) / std::max<uint64_t>(1, att.reads - readsBefore));
+        munmap(state, size);
+    }
+
+    // one frame of scene update, every seat active and a spin landing on each
+    {
+        CasinoSnap snap;
+        snap.jackpot = 100000;
+        snap.playerCount = MAX_VISIBLE_SEATS;
+        snap.players.resize(MAX_VISIBLE_SEATS);
+        for (int i = 0; i < MAX_VISIBLE_SEATS; ++i) {
+            snap.players[i].id = i;
+            snap.players[i].x = 100.0f + i * 60.0f;
+            snap.players[i].y = 300.0f;
+            snap.players[i].spinning = i % 2;
+            casino::SpinEvent ev{};
+            ev.playerId = i;
+            ev.seat = i;
+            ev.delta = i % 4 == 1 ? 200 : -20;
+            snap.events.push_back(ev);
+        }
+        SceneState scene;
+        suite.run("update_scene/" + std::to_string(MAX_VISIBLE_SEATS) + "_seats", 1,
+                  [&]() { update_scene(scene, snap, 1.0f / 60.0f); });
+    }
+
+    // label layout with a fake font (glyphs only need a nonzero texture id)
+    {
+        Assets assets{};
+        for (const char* c = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"; *c; ++c) {
+            BitmapGlyph g{};
+            g.texture.id = 1;
+            g.width = 24 + (*c % 7);
+            g.height = 32;
+            g.advance = g.width + 2;
+            assets.bitmapFont.glyphs[*c] = g;
+        }
+        assets.bitmapFont.maxHeight = 32;
+        assets.bitmapFont.loaded = true;
+        std::vector<TextQuad> quads;
+        const std::string label = "P1024 JACKPOT 125000 Rounds: 4821";
+        suite.run("layout_bitmap_text/label", 1, [&]() {
+            bench::keep(layout_bitmap_text(assets, label, {100.0f, 50.0f}, 22.0f, 1.0f, quads));
+        });
+    }
+
+    // loaders on large inputs (ns per slot)
+    for (int slots : {16, 4096}) {
+        const std::string scenePath = write_temp(scene_json(slots));
+        const std::string tmjPath = write_temp(tiled_tmj(slots));
+        LayoutParams params;
+        std::vector<SlotLayout> layouts;
+        std::vector<Vector2> positions;
+        suite.run("load_scene_file/" + std::to_string(slots) + "_slots", slots,
+                  [&]() { bench::keep(load_scene_file(scenePath, params, layouts, &positions)); });
+        suite.run("load_tiled_tmj/" + std::to_string(slots) + "_slots", slots,
+                  [&]() { bench::keep(load_tiled_tmj(tmjPath, params, layouts, &positions)); });
+        unlink(scenePath.c_str());
+        unlink(tmjPath.c_str());
+    }
+
+    return suite.finish() ? 0 : 1;
+}
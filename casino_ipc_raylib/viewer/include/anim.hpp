@@ -26,15 +26,22 @@ struct Confetto {
     bool alive = false;
 };
 
+// Spin reçu, en attente de la fin de son animation ; polledNs = copy_snapshot
+// qui l'a ramassé (trace mise → pixel).
+struct PendingResult {
+    casino::SpinEvent ev;
+    uint64_t polledNs = 0;
+};
+
 struct SceneState {
-    std::array<PlayerVisual, casino::MAX_PLAYERS> players;
+    std::array<PlayerVisual, MAX_VISIBLE_SEATS> players;
     std::array<Confetto, 64> confetti;
     float glowPhase = 0.0f;
-    int lastWinSeen = -1;
-    std::array<std::vector<int>, casino::MAX_PLAYERS> history; // dernières variations
-    std::array<float, casino::MAX_PLAYERS> lastResultTime{};   // timestamp (GetTime) du dernier résultat
-    std::array<bool, casino::MAX_PLAYERS> prevSpinning{};      // pour détecter fin de spin
-    std::array<bool, casino::MAX_PLAYERS> showWinPose{};       // sprite victoire actif ?
+    std::array<std::vector<int>, MAX_VISIBLE_SEATS> history; // dernières variations
+    std::array<float, MAX_VISIBLE_SEATS> lastResultTime{};   // timestamp (GetTime) du dernier résultat
+    std::vector<PendingResult> pendingResults;                // spins reçus dont l'animation n'est pas finie
+    std::vector<PendingResult> revealed;                      // résultats révélés par le dernier update_scene
+    std::array<bool, MAX_VISIBLE_SEATS> showWinPose{};       // sprite victoire actif ?
     int totalBank = 0;                                         // cumul gains/pertes
     bool bankInitialized = false;
     bool jackpotInitialized = false;
@@ -2,14 +2,45 @@
 
 #include <optional>
 #include <pthread.h>
+#include <vector>
 #include "snapshot.hpp"
+#include "event_ring.hpp"
+
+// Reads that needed more seqlock retries than this are counted as slow.
+constexpr int SLOW_READ_RETRIES = 4;
 
 struct SharedAttachment {
     int fd = -1;
-    casino::SharedState* state = nullptr;
+    const casino::SharedState* state = nullptr; // mapped PROT_READ, never locked
+    size_t size = 0;                            // mapped bytes, from the segment header
     bool valid = false;
+    // seqlock reader statistics (kept locally: the mapping is read-only)
+    uint64_t reads = 0;
+    uint64_t retries = 0;     // total retries across all reads
+    uint64_t slowReads = 0;   // reads with more than SLOW_READ_RETRIES retries
+    uint64_t failedReads = 0; // reads that never saw a stable sequence
+    uint64_t unchangedReads = 0; // copies skipped: the generation had not moved
+    uint64_t seatsCopied = 0;    // seats copied out of the segment since attach
+    casino::EventCursor events{}; // this viewer's position in the spin event ring
+    uint64_t epoch = 0;           // header.epoch at attach
+    // change tracking: generation of the last copy (valid once synced), the
+    // seats that copy took and the seats still animating in the snapshot
+    uint32_t generation = 0;
+    bool synced = false;
+    std::vector<uint32_t> changed;
+    std::vector<uint32_t> animating;
 };
 
-std::optional<SharedAttachment> attach_shared_state();
+// Attaches to the segment of `table` (0: the historical name), retrying for
+// up to waitMs while the server starts.
+std::optional<SharedAttachment> attach_shared_state(int table = 0, int waitMs = 3000);
 void detach_shared_state(SharedAttachment&);
+// True once the server replaced the segment (unlinked: restarted on a fresh
+// one) or restarted on it (new epoch, --state-file): re-attach by name.
+bool attachment_stale(const SharedAttachment&);
+// Copies the state and replaces out.events with the spin events published
+// since the previous call. `out` must be the snapshot of the previous call:
+// only the seats the server changed since then are copied again, and nothing
+// at all while the generation is unchanged; the animations of seats still
+// spinning or glowing are re-evaluated at the current time.
 bool copy_snapshot(SharedAttachment&, CasinoSnap& out);
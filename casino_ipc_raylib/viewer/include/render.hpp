@@ -1,6 +1,8 @@
 #pragma once
 
 #include <raylib.h>
+#include <string>
+#include <vector>
 #include "snapshot.hpp"
 #include "assets.hpp"
 #include "anim.hpp"
@@ -11,6 +13,18 @@ struct RenderSettings {
     int height = 1080;
 };
 
+// One character of a bitmap-font label: a glyph quad, or (glyph null) a
+// character the font lacks, drawn with the UI font at dst.
+struct TextQuad {
+    const BitmapGlyph* glyph = nullptr;
+    char ch = 0;
+    Rectangle dst{};
+};
+
+// Places `text` from pos without drawing (kerning included); returns its width.
+// Needs assets.bitmapFont.loaded.
+float layout_bitmap_text(const Assets& assets, const std::string& text, Vector2 pos, float fontSize, float spacing, std::vector<TextQuad>& out);
+
 void set_layout_params(const LayoutParams& params);
 void set_slot_layout(int idx, const SlotLayout& slot);
 void set_slot_position(int idx, Vector2 pos);
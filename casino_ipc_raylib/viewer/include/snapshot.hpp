@@ -2,7 +2,13 @@
 
 #include <cstdint>
 #include <array>
+#include <vector>
 #include "protocol.hpp"
+#include "latency_hist.hpp"
+
+// Seats the scene lays out and animates; the snapshot itself holds every seat
+// of the segment (header.capacity), the renderer only draws the first ones.
+constexpr int MAX_VISIBLE_SEATS = casino::DEFAULT_PLAYERS;
 
 struct CasinoSnap {
     uint64_t tick = 0;
@@ -11,10 +17,39 @@ struct CasinoSnap {
     int32_t lastWinnerId = -1;
     int32_t lastWinAmount = 0;
     int32_t playerCount = 0;
-    casino::PlayerState players[casino::MAX_PLAYERS]{};
+    uint32_t capacity = 0;                    // header.capacity of the attached segment
+    uint32_t table_id = 0;                    // table shown (header.tableId)
+    uint32_t table_count = 1;
+    std::vector<casino::PlayerState> players; // sized from the segment header
+    uint32_t generation = 0;                  // segment generation the copy reflects
+    uint32_t seats_copied = 0;                // seats the last copy took from the segment
     // mirrored instrumentation from shared state
     int32_t mutex_held = 0;
     uint64_t mutex_last_held_ts = 0;
-    int32_t sem_value = 0;
-    int32_t mq_count = 0;
+    int32_t bet_depth = 0;
+    uint64_t bet_overflows = 0;
+    uint64_t bet_wakeups = 0;
+    uint64_t bet_abandoned = 0; // ring tickets claimed but never published
+    uint64_t bet_deferred = 0;  // bets held until their seat's cooldown ended
+    uint64_t bet_coalesced = 0; // bets folded into an already held one
+    uint64_t bet_expired = 0;   // held bets dropped after --bet-ttl-ms
+    uint64_t bet_frames = 0;    // bet frames drained, and their sequence faults
+    uint64_t bet_seq_gaps = 0;
+    uint64_t bet_seq_dups = 0;
+    uint64_t bet_bad_frames = 0;
+    uint32_t bet_transport = casino::BET_TRANSPORT_RING;
+    uint64_t batch_commits = 0;
+    uint32_t batch_max = 0;
+    std::array<uint64_t, casino::BATCH_HIST_BUCKETS> batch_hist{};
+    // spin events published since the previous copy (this viewer's cursor)
+    std::vector<casino::SpinEvent> events;
+    uint64_t events_polled_ns = 0; // CLOCK_MONOTONIC when `events` were read (bet traces)
+    uint64_t events_read = 0; // events consumed since attach
+    uint64_t events_lost = 0; // overwritten before this viewer read them
+    // bet latency percentiles of the table, [stage][verdict] (latency_index)
+    std::array<casino::LatencySummary, casino::LAT_STAGES * casino::BET_VERDICTS> latency{};
+    // mutex wait/hold per LockSite, only filled while the server runs --lock-profile
+    bool lock_profile = false;
+    std::array<casino::LatencySummary, casino::LOCK_SITES> lock_wait{};
+    std::array<casino::LatencySummary, casino::LOCK_SITES> lock_hold{};
 };
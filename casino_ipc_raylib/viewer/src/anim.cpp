@@ -1,7 +1,8 @@
 #include "anim.hpp"
 
-#include <cmath>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <raylib.h>
 #include <raymath.h>
 
@@ -16,15 +17,16 @@ void update_scene(SceneState& scene, const CasinoSnap& snap, float dt) {
         scene.triggerEmptySfx = true;
         scene.gameOver = true;
     }
-    for (int i = 0; i < casino::MAX_PLAYERS; ++i) {
+    const int visible = std::min(snap.playerCount, MAX_VISIBLE_SEATS);
+    for (int i = 0; i < MAX_VISIBLE_SEATS; ++i) {
         auto& pv = scene.players[i];
-        if (i < snap.playerCount) {
+        if (i < visible) {
             int pid = snap.players[i].id;
             int slot = pid;
-            if (slot < 0 || slot >= casino::MAX_PLAYERS) slot = i;
+            if (slot < 0 || slot >= MAX_VISIBLE_SEATS) slot = i;
             int targetSlot = slot;
-            if (snap.playerCount > 0) {
-                targetSlot = (slot - 1 + snap.playerCount) % snap.playerCount; // décale la célébration sur le sprite précédent
+            if (visible > 0) {
+                targetSlot = (slot - 1 + visible) % visible; // décale la célébration sur le sprite précédent
             }
             pv.active = true;
             const float offsetX = 260.0f - 62.0f; // base offset minus left shift
@@ -45,31 +47,11 @@ void update_scene(SceneState& scene, const CasinoSnap& snap, float dt) {
             pv.spinning = snap.players[i].spinning != 0;
             pv.spinProgress = snap.players[i].spinProgress;
 
-            bool prevSpin = scene.prevSpinning[slot];
             if (pv.spinning) {
                 // reroll: reset win pose to base sprite immediately
                 scene.showWinPose[slot] = false;
                 scene.showWinPose[targetSlot] = false;
             }
-
-            // détecter fin de spin pour historiser le delta
-            if (prevSpin && !pv.spinning) {
-                float now = GetTime();
-                scene.lastResultTime[slot] = now;
-                auto& hist = scene.history[slot];
-                hist.push_back(pv.lastDelta);
-                if (hist.size() > 4) {
-                    hist.erase(hist.begin(), hist.end() - 4);
-                }
-                // cumul global + sprite victoire
-                scene.totalBank += pv.lastDelta;
-                scene.bankInitialized = true;
-                scene.showWinPose[targetSlot] = pv.lastDelta > 0;
-                if (pv.lastDelta > 0) {
-                    scene.triggerWinSfx = true;
-                }
-            }
-            scene.prevSpinning[slot] = pv.spinning;
         } else {
             pv.active = false;
         }
@@ -78,18 +60,43 @@ void update_scene(SceneState& scene, const CasinoSnap& snap, float dt) {
     scene.glowPhase += dt * 2.0f;
     if (scene.glowPhase > 6.28318f) scene.glowPhase -= 6.28318f;
 
-    // Confettis déclenchés à la fin d'un spin gagnant (pas dès le résultat backend)
-    for (int i = 0; i < snap.playerCount; ++i) {
-        int pid = snap.players[i].id;
-        if (pid < 0 || pid >= casino::MAX_PLAYERS) pid = i;
-        bool prevSpin = scene.prevSpinning[pid];
-        bool nowSpin = scene.players[i].spinning;
-        bool justEnded = prevSpin && !nowSpin;
-        bool win = scene.players[i].lastDelta > 0;
-        if (justEnded && win && scene.lastWinSeen != pid) {
-            scene.lastWinSeen = pid;
-            float baseX = scene.players[i].pos.x;
-            float baseY = scene.players[i].pos.y - 40;
+    // Spin events are revealed when their reel animation ends (the server
+    // animates SPIN_DURATION_MS from the commit), not as soon as the backend
+    // decided them: history, bank, win pose, SFX and confetti all hang off this.
+    // The frame drawing this update is the first to show them: the bet-to-pixel
+    // trace stamps "present" there (scene.revealed).
+    for (const casino::SpinEvent& ev : snap.events) scene.pendingResults.push_back(PendingResult{ev, snap.events_polled_ns});
+    scene.revealed.clear();
+    const uint64_t nowNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+    const uint64_t spinNs = static_cast<uint64_t>(casino::SPIN_DURATION_MS) * 1000000ull;
+    size_t kept = 0;
+    for (const PendingResult& pending : scene.pendingResults) {
+        const casino::SpinEvent& ev = pending.ev;
+        if (ev.timestampNs + spinNs > nowNs) {
+            scene.pendingResults[kept++] = pending;
+            continue;
+        }
+        if (ev.seat < 0 || ev.seat >= visible) continue;
+        scene.revealed.push_back(pending);
+        int slot = ev.playerId;
+        if (slot < 0 || slot >= MAX_VISIBLE_SEATS) slot = ev.seat;
+        int targetSlot = (slot - 1 + visible) % visible; // décale la célébration sur le sprite précédent
+        scene.lastResultTime[slot] = GetTime();
+        auto& hist = scene.history[slot];
+        hist.push_back(ev.delta);
+        if (hist.size() > 4) {
+            hist.erase(hist.begin(), hist.end() - 4);
+        }
+        // cumul global + sprite victoire
+        scene.totalBank += ev.delta;
+        scene.bankInitialized = true;
+        scene.showWinPose[targetSlot] = ev.delta > 0;
+        if (ev.delta > 0) {
+            scene.triggerWinSfx = true;
+            // Confettis à la fin d'un spin gagnant
+            float baseX = scene.players[ev.seat].pos.x;
+            float baseY = scene.players[ev.seat].pos.y - 40;
             for (auto& c : scene.confetti) {
                 c.alive = true;
                 c.life = 0.6f + GetRandomValue(0, 30) / 100.0f;
@@ -99,6 +106,7 @@ void update_scene(SceneState& scene, const CasinoSnap& snap, float dt) {
             }
         }
     }
+    scene.pendingResults.resize(kept);
 
     for (auto& c : scene.confetti) {
         if (!c.alive) continue;
@@ -1,49 +1,74 @@
 #include "ipc_attach.hpp"
-#include "ipc_shared.hpp" // for safe_mutex_lock and open_shared_memory
+#include "ipc_shared.hpp" // for read_consistent
+#include "lock_profile.hpp"
 
+#include <algorithm>
 #include <cerrno>
+#include <cstdlib>
 #include <cstring>
 #include <fcntl.h>
 #include <iostream>
+#include <iterator>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <thread>
 #include <chrono>
 
-std::optional<SharedAttachment> attach_shared_state() {
+std::optional<SharedAttachment> attach_shared_state(int table, int waitMs) {
     // Retry opening shared memory for a short period to avoid race at startup
-    const int maxMs = 3000; // total wait time
+    // (segment missing, not yet truncated, or header not yet published)
     const int stepMs = 100; // wait step
     int waited = 0;
-    int fd = -1;
-    while (waited <= maxMs) {
-        fd = shm_open(casino::SHM_NAME, O_RDWR, 0666);
-        if (fd >= 0) break;
+    while (true) {
+        // POSIX shm object, or the CASINO_STATE_FILE file of a --state-file server
+        int fd = casino::open_segment_fd(table, O_RDONLY, 0);
+        struct stat st{};
+        if (fd >= 0 && fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(casino::SharedState)) {
+            size_t size = static_cast<size_t>(st.st_size);
+            // read-only mapping: the viewer never writes nor locks the shared state
+            void* addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            if (addr == MAP_FAILED) {
+                std::cerr << "[viewer] mmap failed: " << std::strerror(errno) << "\n";
+                close(fd);
+                return std::nullopt;
+            }
+            auto* state = reinterpret_cast<const casino::SharedState*>(addr);
+            if (casino::validate_header(state, size)) {
+                // CASINO_REALTIME: no page fault while copying snapshots (server --realtime)
+                if (std::getenv("CASINO_REALTIME")) casino::prefault_mapping(addr, size, fd, false);
+                SharedAttachment att{};
+                att.fd = fd;
+                att.state = state;
+                att.size = size;
+                att.valid = true;
+                att.epoch = state->header.epoch.load(std::memory_order_acquire);
+                // only spins landing after the attach are replayed as events
+                att.events = casino::event_cursor_at_head(casino::event_ring_of(state));
+                return att;
+            }
+            munmap(addr, size);
+        }
+        if (fd >= 0) close(fd);
+        if (waited >= waitMs) break;
         // sleep and retry
         std::this_thread::sleep_for(std::chrono::milliseconds(stepMs));
         waited += stepMs;
     }
-    if (fd < 0) {
-        std::cerr << "[viewer] shm_open failed after retries: " << std::strerror(errno) << "\n";
-        return std::nullopt;
-    }
-    void* addr = mmap(nullptr, sizeof(casino::SharedState), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-    if (addr == MAP_FAILED) {
-        std::cerr << "[viewer] mmap failed: " << std::strerror(errno) << "\n";
-        close(fd);
-        return std::nullopt;
-    }
-    SharedAttachment att{};
-    att.fd = fd;
-    att.state = reinterpret_cast<casino::SharedState*>(addr);
-    att.valid = true;
-    return att;
+    if (waitMs > 0) std::cerr << "[viewer] no valid shared segment after retries: " << std::strerror(errno) << "\n";
+    return std::nullopt;
+}
+
+bool attachment_stale(const SharedAttachment& att) {
+    if (!att.valid || !att.state) return true;
+    struct stat st{};
+    if (fstat(att.fd, &st) != 0 || st.st_nlink == 0) return true;
+    return att.state->header.epoch.load(std::memory_order_acquire) != att.epoch;
 }
 
 void detach_shared_state(SharedAttachment& att) {
     if (att.state) {
-        munmap(att.state, sizeof(casino::SharedState));
+        munmap(const_cast<casino::SharedState*>(att.state), att.size);
         att.state = nullptr;
     }
     if (att.fd >= 0) {
@@ -55,36 +80,128 @@ void detach_shared_state(SharedAttachment& att) {
 
 bool copy_snapshot(SharedAttachment& att, CasinoSnap& out) {
     if (!att.valid || !att.state) return false;
-    // try a few times to lock the mutex, with short backoff
-    const int maxAttempts = 6;
-    int attempt = 0;
-    bool locked = false;
-    while (attempt < maxAttempts) {
-        if (casino::safe_mutex_lock(&att.state->mutex)) {
-            locked = true;
-            break;
+    const casino::SharedState* st = att.state;
+    const casino::ConstPlayerArrays players = casino::players_of(st);
+    const int capacity = static_cast<int>(st->header.capacity); // immutable once published
+    if (static_cast<int>(out.players.size()) != capacity) {
+        out.players.resize(capacity);
+        att.synced = false;
+    }
+    out.capacity = static_cast<uint32_t>(capacity);
+    // spin progress and pulse are evaluated here, at this frame's time, from the
+    // stamps the server wrote once per spin
+    const uint64_t nowNs = casino::monotonic_ns();
+    out.seats_copied = 0;
+    if (att.synced && st->generation.load(std::memory_order_acquire) == att.generation) {
+        att.unchangedReads++; // nothing published since the last copy
+    } else {
+        // taken before the read: a torn attempt may already have overwritten
+        // out.playerCount, and the retry must still compare against the last
+        // consistent copy
+        const int previousCount = out.playerCount;
+        // seqlock read: copy, then retry if the server published in the meantime
+        int retries = casino::read_consistent(st, [&]() {
+            out.generation = st->generation.load(std::memory_order_relaxed);
+            out.tick = st->tick;
+            out.jackpot = st->jackpot;
+            out.rounds = st->rounds;
+            out.lastWinnerId = st->lastWinnerId;
+            out.lastWinAmount = st->lastWinAmount;
+            out.playerCount = st->playerCount;
+            int count = std::clamp<int>(st->playerCount, 0, capacity);
+            // only the seats stamped since the last copy, every seat the first time
+            att.changed.clear();
+            if (!att.synced || count != previousCount ||
+                !casino::collect_changed_seats(st, players, att.generation, count, att.changed)) {
+                att.changed.clear();
+                for (int i = 0; i < count; ++i) att.changed.push_back(static_cast<uint32_t>(i));
+            }
+            // gather the cold records, hot arrays and pids back into one record per seat
+            for (uint32_t i : att.changed) out.players[i] = players.load(static_cast<int>(i), nowNs);
+            // copy instrumentation
+            out.mutex_held = st->mutex_held;
+            out.bet_depth = st->bet_depth;
+            out.bet_overflows = st->bet_overflows;
+            out.bet_wakeups = st->bet_wakeups;
+            out.bet_abandoned = st->bet_abandoned;
+            out.bet_deferred = st->bet_deferred;
+            out.bet_coalesced = st->bet_coalesced;
+            out.bet_expired = st->bet_expired;
+            out.bet_frames = st->bet_frames;
+            out.bet_seq_gaps = st->bet_seq_gaps;
+            out.bet_seq_dups = st->bet_seq_dups;
+            out.bet_bad_frames = st->bet_bad_frames;
+            out.bet_transport = st->header.betTransport;
+            out.table_id = st->header.tableId;
+            out.table_count = st->header.tableCount;
+            out.batch_commits = st->batch_commits;
+            out.batch_max = st->batch_max;
+            std::copy(std::begin(st->batch_hist), std::end(st->batch_hist), out.batch_hist.begin());
+            out.mutex_last_held_ts = st->mutex_last_held_ts;
+        });
+        att.reads++;
+        if (retries < 0) {
+            att.failedReads++;
+            att.synced = false;
+            std::cerr << "[viewer] no consistent snapshot after retries (writer stalled?)\n";
+            return false;
+        }
+        att.retries += static_cast<uint64_t>(retries);
+        if (retries > SLOW_READ_RETRIES) att.slowReads++;
+        att.generation = out.generation;
+        att.synced = true;
+        out.seats_copied = static_cast<uint32_t>(att.changed.size());
+        att.seatsCopied += att.changed.size();
+    }
+
+    // seats copied above are animated already; the others still animating are
+    // re-evaluated from their copied stamps (both lists ascending, merged)
+    std::vector<uint32_t> still;
+    still.reserve(att.animating.size() + out.seats_copied);
+    const uint32_t* copied = att.changed.data();
+    const uint32_t* copiedEnd = copied + out.seats_copied;
+    const int count = std::clamp<int>(out.playerCount, 0, capacity);
+    for (uint32_t i : att.animating) {
+        for (; copied != copiedEnd && *copied < i; ++copied) {
+            if (out.players[*copied].spinning || out.players[*copied].pulse > 0.0f) still.push_back(*copied);
+        }
+        if (copied != copiedEnd && *copied == i) continue; // taken by the copied loop
+        if (static_cast<int>(i) < count && casino::animate_player(out.players[i], players.spinDurationNs, nowNs)) {
+            still.push_back(i);
         }
-        ++attempt;
-        std::this_thread::sleep_for(std::chrono::milliseconds(20 * attempt));
     }
-    if (!locked) {
-        std::cerr << "[viewer] failed to lock shared mutex after retries\n";
-        return false;
+    for (; copied != copiedEnd; ++copied) {
+        if (out.players[*copied].spinning || out.players[*copied].pulse > 0.0f) still.push_back(*copied);
+    }
+    att.animating.swap(still);
+
+    // new spin events only: O(events since the last frame), no snapshot diffing
+    const casino::EventRing* ring = casino::event_ring_of(st);
+    out.events.clear();
+    casino::SpinEvent chunk[64];
+    size_t n = 0;
+    while ((n = casino::event_ring_read(ring, att.events, chunk, std::size(chunk))) > 0) {
+        out.events.insert(out.events.end(), chunk, chunk + n);
+    }
+    out.events_polled_ns = casino::monotonic_ns();
+    out.events_read += out.events.size();
+    out.events_lost = att.events.lost;
+
+    // latency histograms are read live, outside the seqlock (single writer, monotonic counters)
+    const casino::LatencyHistogram* block = casino::latency_block_of(st);
+    for (int stage = 0; stage < casino::LAT_STAGES; ++stage) {
+        for (int v = 0; v < casino::BET_VERDICTS; ++v) {
+            size_t index = casino::latency_index(stage, v);
+            out.latency[index] = casino::latency_summarize(block[index]);
+        }
     }
-    out.tick = att.state->tick;
-    out.jackpot = att.state->jackpot;
-    out.rounds = att.state->rounds;
-    out.lastWinnerId = att.state->lastWinnerId;
-    out.lastWinAmount = att.state->lastWinAmount;
-    out.playerCount = att.state->playerCount;
-    for (int i = 0; i < att.state->playerCount && i < casino::MAX_PLAYERS; ++i) {
-        out.players[i] = att.state->players[i];
+    out.lock_profile = st->header.lockProfile != 0;
+    if (out.lock_profile) {
+        const casino::LockSiteProfile* profiles = casino::lock_profile_of(st);
+        for (int site = 0; site < casino::LOCK_SITES; ++site) {
+            out.lock_wait[site] = casino::latency_summarize(profiles[site].wait);
+            out.lock_hold[site] = casino::latency_summarize(profiles[site].hold);
+        }
     }
-    // copy instrumentation
-    out.mutex_held = att.state->mutex_held;
-    out.sem_value = att.state->sem_value;
-    out.mq_count = att.state->mq_count;
-    out.mutex_last_held_ts = att.state->mutex_last_held_ts;
-    pthread_mutex_unlock(&att.state->mutex);
     return true;
 }
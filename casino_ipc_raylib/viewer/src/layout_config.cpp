@@ -3,7 +3,7 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
-#include "protocol.hpp"
+#include "snapshot.hpp"
 #include <string>
 #include <algorithm>
 
@@ -43,7 +43,7 @@ bool load_layout_params(const std::string& path, LayoutParams& out) {
 
 bool load_layout_file(const std::string& path, LayoutParams& out, std::vector<SlotLayout>& slots) {
     slots.clear();
-    slots.resize(casino::MAX_PLAYERS);
+    slots.resize(MAX_VISIBLE_SEATS);
     std::ifstream f(path);
     if (!f.is_open()) return false;
     std::string tag;
@@ -115,7 +115,7 @@ bool load_scene_file(const std::string& path, LayoutParams& params, std::vector<
     if (!f.is_open()) return false;
     std::string content((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
     slots.clear();
-    slots.resize(casino::MAX_PLAYERS);
+    slots.resize(MAX_VISIBLE_SEATS);
     if (positions) positions->clear();
     // parse ui
     params.panelScale = extract_value(content, "panelScale", params.panelScale);
@@ -138,7 +138,7 @@ bool load_scene_file(const std::string& path, LayoutParams& params, std::vector<
     auto arrEnd = content.find(']', slotsPos);
     if (arrStart == std::string::npos || arrEnd == std::string::npos) return true;
     size_t pos = arrStart;
-    if (positions) positions->resize(casino::MAX_PLAYERS, Vector2{0,0});
+    if (positions) positions->resize(MAX_VISIBLE_SEATS, Vector2{0,0});
     int count = 0;
     while (true) {
         auto objStart = content.find('{', pos);
@@ -158,7 +158,7 @@ bool load_scene_file(const std::string& path, LayoutParams& params, std::vector<
         float x = extract_value(obj, "x", 960.0f);
         float y = extract_value(obj, "y", 540.0f);
         int sid = (int)extract_value(obj, "id", (float)count);
-        if (sid < 0 || sid >= casino::MAX_PLAYERS) sid = count;
+        if (sid < 0 || sid >= MAX_VISIBLE_SEATS) sid = count;
         if (sid >= (int)slots.size()) slots.resize(sid + 1);
         slots[sid] = sl;
         if (positions) {
@@ -187,8 +187,8 @@ bool load_tiled_tmj(const std::string& path, LayoutParams& params, std::vector<S
     if (!f.is_open()) return false;
     std::string content((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
     slots.clear();
-    slots.resize(casino::MAX_PLAYERS);
-    if (positions) { positions->clear(); positions->reserve(casino::MAX_PLAYERS); }
+    slots.resize(MAX_VISIBLE_SEATS);
+    if (positions) { positions->clear(); positions->reserve(MAX_VISIBLE_SEATS); }
 
     // map-level properties (ui)
     params.panelScale = find_prop_value(content, "panelScale", params.panelScale);
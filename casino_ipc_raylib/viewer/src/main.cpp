@@ -1,6 +1,7 @@
 #include <chrono>
 #include <filesystem>
 #include <cmath>
+#include <cstdio>
 #include <iostream>
 #include <raylib.h>
 #include <algorithm>
@@ -11,6 +12,8 @@
 
 #include "assets.hpp"
 #include "ipc_attach.hpp"
+#include "ipc_shared.hpp" // monotonic_ns
+#include "viewer_stats.hpp"
 #include "render.hpp"
 #include "anim.hpp"
 #include "layout_config.hpp"
@@ -93,7 +96,7 @@ static bool show_main_menu(const Assets& assets, const RenderSettings& cfg) {
                 // right info/jackpot summary
                 items.push_back({{(float)cfg.width - 220.0f, 80.0f}, "Informations: affiche le dernier gagnant, le jackpot et le cumul global."});
                 // IPC/server note (bottom-center)
-                items.push_back({{(float)cfg.width * 0.5f, (float)cfg.height - 60.0f}, "Architecture: serveur (process) met à jour la mémoire partagée; les joueurs envoient des messages via une MQ; sémaphores réveillent le serveur."});
+                items.push_back({{(float)cfg.width * 0.5f, (float)cfg.height - 60.0f}, "Architecture: serveur (process) met à jour la mémoire partagée; les joueurs publient leurs mises dans un ring en mémoire partagée (MQ en secours); un futex réveille le serveur."});
 
                 size_t step = 0;
                 Texture2D cursorTex = assets.textures.cursor;
@@ -125,12 +128,13 @@ static bool show_main_menu(const Assets& assets, const RenderSettings& cfg) {
                     // build a static snapshot (freeze animations) from scratch
                     CasinoSnap staticSnap{};
                     staticSnap.playerCount = 6;
+                    staticSnap.players.resize(MAX_VISIBLE_SEATS);
                     staticSnap.jackpot = 1200;
                     staticSnap.rounds = 0;
                     const float cx = cfg.width * 0.5f;
                     const float cy = cfg.height * 0.5f + 60.0f;
                     const float radius = std::min(cfg.width, cfg.height) * 0.25f;
-                    for (int i = 0; i < staticSnap.playerCount && i < casino::MAX_PLAYERS; ++i) {
+                    for (int i = 0; i < staticSnap.playerCount && i < MAX_VISIBLE_SEATS; ++i) {
                         float angle = 3.14159f / 2 + (6.28318f * i / std::max(6, staticSnap.playerCount));
                         staticSnap.players[i].id = i;
                         staticSnap.players[i].x = cx + radius * std::cos(angle);
@@ -144,7 +148,7 @@ static bool show_main_menu(const Assets& assets, const RenderSettings& cfg) {
                         staticSnap.players[i].pulse = 0.2f;
                     }
                     SceneState staticScene{};
-                    for (int i = 0; i < casino::MAX_PLAYERS; ++i) {
+                    for (int i = 0; i < MAX_VISIBLE_SEATS; ++i) {
                         staticScene.players[i].active = (i < staticSnap.playerCount);
                         staticScene.players[i].pos.x = staticSnap.players[i].x;
                         staticScene.players[i].pos.y = staticSnap.players[i].y;
@@ -240,7 +244,7 @@ static bool show_main_menu(const Assets& assets, const RenderSettings& cfg) {
                     helpLP.panelScale = 1.0f;
                     set_layout_params(helpLP);
                     // Position slots to match the static snapshot
-                    for (int i = 0; i < staticSnap.playerCount && i < casino::MAX_PLAYERS; ++i) {
+                    for (int i = 0; i < staticSnap.playerCount && i < MAX_VISIBLE_SEATS; ++i) {
                         SlotLayout sl{};
                         sl.slotScale = helpLP.slotScale;
                         sl.symbolScale = helpLP.symbolScale;
@@ -280,7 +284,7 @@ static bool show_main_menu(const Assets& assets, const RenderSettings& cfg) {
                         DrawLine((int)tv.x - 6, (int)tv.y, (int)tv.x + 6, (int)tv.y, GREEN);
                         DrawLine((int)tv.x, (int)tv.y - 6, (int)tv.x, (int)tv.y + 6, GREEN);
                         char dbuf[128];
-                        std::snprintf(dbuf, sizeof(dbuf), "T:(%.0f,%.0f) C:(%.0f,%.0f) P:(%.0f,%.0f)", tv.x, tv.y, cursorPos.x, cursorPos.y, panel.x, panel.y);
+                        std::snprintf(dbuf, sizeof(dbuf), "T:(%.0f,%.0f) C:(%.0f,%.0f) P:(%.0f,%.0f)", tv.x, tv.y, cursorPos.x, cursorPos.y, helpPanel.x, helpPanel.y);
                         DrawText(dbuf, (int)(helpPanel.x + 8), (int)(helpPanel.y + helpPanel.height - 48), 14, Color{220,220,220,200});
                     }
 
@@ -393,7 +397,7 @@ int main() {
     }
 
     LayoutParams lp{};
-    std::vector<SlotLayout> slots(casino::MAX_PLAYERS);
+    std::vector<SlotLayout> slots(MAX_VISIBLE_SEATS);
     std::vector<Vector2> slotPositions;
     if (!load_scene_file("scene.json", lp, slots, &slotPositions)) {
         if (!load_tiled_tmj("scene.tmj", lp, slots, &slotPositions)) {
@@ -406,23 +410,71 @@ int main() {
     for (int i = 0; i < (int)slots.size(); ++i) {
         if (slots[i].set) set_slot_layout(i, slots[i]);
     }
-    for (int i = 0; i < (int)slotPositions.size() && i < casino::MAX_PLAYERS; ++i) {
+    for (int i = 0; i < (int)slotPositions.size() && i < MAX_VISIBLE_SEATS; ++i) {
         set_slot_position(i, slotPositions[i]);
     }
 
-    auto attachmentOpt = attach_shared_state();
+    // CASINO_TABLE=t shows table t of a `casino_server --tables N` run
+    int table = 0;
+    if (const char* envTable = std::getenv("CASINO_TABLE")) {
+        table = std::clamp(std::atoi(envTable), 0, casino::MAX_TABLES - 1);
+    }
+    auto attachmentOpt = attach_shared_state(table);
     bool attached = attachmentOpt.has_value();
     if (!attached) {
         std::cerr << "[viewer] Could not attach SHM; running in fallback demo mode." << std::endl;
     }
 
+    // frame times and reader counters for casino_exporter, in this viewer's own segment
+    casino::ViewerStats* viewerStats = casino::viewer_stats_create(table);
+    uint64_t lastFrameNs = casino::monotonic_ns();
+    uint64_t frameIndex = 0;
+    // CASINO_TRACE_LOG=file: one CSV line per bet-traced spin, with the frame that first presented its result
+    std::FILE* traceLog = nullptr;
+    if (const char* path = std::getenv("CASINO_TRACE_LOG")) {
+        traceLog = std::fopen(path, "w");
+        if (traceLog) {
+            std::fprintf(traceLog, "frame,player,sender,seq,index,queue_ns,wakeup_ns,roll_ns,lock_ns,poll_ns,present_ns,total_ns\n");
+        } else {
+            std::cerr << "[viewer] cannot open CASINO_TRACE_LOG " << path << std::endl;
+        }
+    }
+
     CasinoSnap snap{};
     SceneState scene{};
 
+    // a restarted server replaces or re-adopts the segment: follow it (and leave
+    // the fallback demo once a server shows up)
+    auto lastAttachCheck = std::chrono::steady_clock::now();
     auto lastFallback = std::chrono::steady_clock::now();
+    std::vector<long> fallbackCycle(MAX_VISIBLE_SEATS, -1); // fake spin cycle last announced per seat
     while (!WindowShouldClose()) {
         float dt = GetFrameTime();
 
+        auto frameStart = std::chrono::steady_clock::now();
+        if (frameStart - lastAttachCheck >= std::chrono::milliseconds(attached ? 250 : 1000)) {
+            lastAttachCheck = frameStart;
+            if (!attached || attachment_stale(*attachmentOpt)) {
+                auto previous = attachmentOpt;
+                if (previous) detach_shared_state(*previous);
+                attachmentOpt = attach_shared_state(table, 0);
+                if (attachmentOpt && previous) { // exported counters stay monotonic
+                    attachmentOpt->reads += previous->reads;
+                    attachmentOpt->retries += previous->retries;
+                    attachmentOpt->failedReads += previous->failedReads;
+                    attachmentOpt->slowReads += previous->slowReads;
+                    attachmentOpt->unchangedReads += previous->unchangedReads;
+                    attachmentOpt->seatsCopied += previous->seatsCopied;
+                } else if (previous) {
+                    attachmentOpt = previous; // keep the counters, mapping already released
+                }
+                const bool live = attachmentOpt && attachmentOpt->valid;
+                if (live && !attached) std::cerr << "[viewer] attached to table " << table << std::endl;
+                if (!live && attached) std::cerr << "[viewer] server gone; waiting for it" << std::endl;
+                attached = live;
+            }
+        }
+
         if (!scene.gameOver) {
             if (attached) {
                 if (!copy_snapshot(*attachmentOpt, snap)) {
@@ -433,10 +485,14 @@ int main() {
                 auto now = std::chrono::steady_clock::now();
                 float t = std::chrono::duration<float>(now - lastFallback).count();
                 lastFallback = now;
-                snap.playerCount = slotPositions.empty() ? 4 : (int)std::min<size_t>(slotPositions.size(), casino::MAX_PLAYERS);
+                snap.playerCount = slotPositions.empty() ? 4 : (int)std::min<size_t>(slotPositions.size(), MAX_VISIBLE_SEATS);
+                if ((int)snap.players.size() < snap.playerCount) snap.players.resize(snap.playerCount);
                 snap.tick++;
                 snap.jackpot = 1000 + (int)(200 * std::sin(GetTime()));
                 snap.rounds++;
+                snap.events.clear();
+                const uint64_t nowNs = static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count());
                 for (int i = 0; i < snap.playerCount; ++i) {
                     snap.players[i].id = i;
                     if (i < (int)slotPositions.size()) {
@@ -454,6 +510,20 @@ int main() {
                     snap.players[i].lastDelta = (i % 2 == 0) ? 80 : -20;
                     snap.players[i].spinning = (std::fmod(GetTime() + i, 3.0) < 1.5);
                     snap.players[i].spinProgress = std::fmod(GetTime() + i, 3.0f) / 3.0f;
+                    // one synthetic spin event per 3 s cycle, stamped so it is revealed
+                    // when the fake spin stops (1.5 s into the cycle)
+                    long cycle = static_cast<long>(std::floor((GetTime() + i) / 3.0));
+                    if (cycle != fallbackCycle[i]) {
+                        fallbackCycle[i] = cycle;
+                        casino::SpinEvent ev{};
+                        ev.playerId = i;
+                        ev.seat = i;
+                        ev.delta = snap.players[i].lastDelta;
+                        ev.payout = ev.delta > 0 ? ev.delta + 20 : 0;
+                        ev.tick = snap.tick;
+                        ev.timestampNs = nowNs + 1500000000ull - static_cast<uint64_t>(casino::SPIN_DURATION_MS) * 1000000ull;
+                        snap.events.push_back(ev);
+                    }
                 }
             }
 
@@ -477,9 +547,40 @@ int main() {
         scene.triggerWinSfx = false;
         scene.triggerEmptySfx = false;
         render_frame(assets, scene, snap, cfg, attached ? &*attachmentOpt : nullptr);
+
+        uint64_t frameNs = casino::monotonic_ns(); // frame presented: results revealed this frame are on screen
+        frameIndex++;
+        for (const PendingResult& shown : scene.revealed) {
+            const casino::SpinEvent& ev = shown.ev;
+            if (ev.betIndex < 0 || ev.sentNs == 0) continue;
+            casino::viewer_stats_trace(viewerStats, ev, shown.polledNs, frameNs);
+            if (traceLog) {
+                std::fprintf(traceLog, "%llu,%d,%u,%u,%d,%u,%u,%u,%u,%llu,%llu,%llu\n",
+                             static_cast<unsigned long long>(frameIndex), ev.playerId, ev.betSender, ev.betSeq,
+                             ev.betIndex, ev.stageNs[casino::TRACE_QUEUE], ev.stageNs[casino::TRACE_WAKEUP],
+                             ev.stageNs[casino::TRACE_ROLL], ev.stageNs[casino::TRACE_LOCK],
+                             static_cast<unsigned long long>(shown.polledNs - std::min(shown.polledNs, ev.publishedNs)),
+                             static_cast<unsigned long long>(frameNs - shown.polledNs),
+                             static_cast<unsigned long long>(frameNs - std::min(frameNs, ev.sentNs)));
+            }
+        }
+        scene.revealed.clear(); // traced once, even if no update_scene runs next frame
+        casino::ViewerFrameCounters counters;
+        counters.attached = attached;
+        if (attachmentOpt) {
+            counters.seqlockReads = attachmentOpt->reads;
+            counters.seqlockRetries = attachmentOpt->retries;
+            counters.slowReads = attachmentOpt->slowReads;
+        }
+        counters.eventsRead = snap.events_read;
+        counters.eventsLost = snap.events_lost;
+        casino::viewer_stats_frame(viewerStats, frameNs - lastFrameNs, counters);
+        lastFrameNs = frameNs;
     }
+    casino::viewer_stats_destroy(viewerStats);
+    if (traceLog) std::fclose(traceLog);
 
-    if (attached) {
+    if (attachmentOpt) {
         detach_shared_state(*attachmentOpt);
     }
     unload_assets(assets);
@@ -8,8 +8,6 @@
 #include <cctype>
 #include "layout_config.hpp"
 #include "ipc_attach.hpp"
-#include <semaphore.h>
-#include <mqueue.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <chrono>
@@ -26,11 +24,8 @@ static void draw_texture_or_rect(const Texture2D& tex, Rectangle dest, Color tin
     }
 }
 
-static float draw_bitmap_text(const Assets& assets, const std::string& text, Vector2 pos, float fontSize, float spacing, Color tint) {
-    if (!assets.bitmapFont.loaded) {
-        DrawTextEx(assets.uiFont, text.c_str(), pos, fontSize, spacing, tint);
-        return MeasureTextEx(assets.uiFont, text.c_str(), fontSize, spacing).x;
-    }
+float layout_bitmap_text(const Assets& assets, const std::string& text, Vector2 pos, float fontSize, float spacing, std::vector<TextQuad>& out) {
+    out.clear();
     float scale = fontSize / (float)assets.bitmapFont.maxHeight;
     float x = pos.x;
     char prev = 0;
@@ -50,17 +45,15 @@ static float draw_bitmap_text(const Assets& assets, const std::string& text, Vec
         auto it = assets.bitmapFont.glyphs.find(ch);
         if (it != assets.bitmapFont.glyphs.end() && it->second.texture.id != 0) {
             const auto& g = it->second;
-            Rectangle src{0, 0, (float)g.texture.width, (float)g.texture.height};
             float w = g.width * scale;
             float h = g.height * scale;
-            Rectangle dst{x, pos.y, w, h};
-            DrawTexturePro(g.texture, src, dst, {0, 0}, 0.0f, tint);
+            out.push_back({&g, raw, Rectangle{x, pos.y, w, h}});
             x += g.advance * scale + spacing;
             prevWidth = w;
         } else {
-            std::string tmp(1, raw);
-            Vector2 sz = MeasureTextEx(assets.uiFont, tmp.c_str(), fontSize, spacing);
-            DrawTextEx(assets.uiFont, tmp.c_str(), {x, pos.y}, fontSize, spacing, tint);
+            char tmp[2] = {raw, 0};
+            Vector2 sz = MeasureTextEx(assets.uiFont, tmp, fontSize, spacing);
+            out.push_back({nullptr, raw, Rectangle{x, pos.y, sz.x, fontSize}});
             x += sz.x + spacing;
             prevWidth = sz.x;
         }
@@ -69,6 +62,25 @@ static float draw_bitmap_text(const Assets& assets, const std::string& text, Vec
     return x - pos.x;
 }
 
+static float draw_bitmap_text(const Assets& assets, const std::string& text, Vector2 pos, float fontSize, float spacing, Color tint) {
+    if (!assets.bitmapFont.loaded) {
+        DrawTextEx(assets.uiFont, text.c_str(), pos, fontSize, spacing, tint);
+        return MeasureTextEx(assets.uiFont, text.c_str(), fontSize, spacing).x;
+    }
+    static std::vector<TextQuad> quads; // reused across labels, render thread only
+    float width = layout_bitmap_text(assets, text, pos, fontSize, spacing, quads);
+    for (const TextQuad& q : quads) {
+        if (q.glyph) {
+            const Texture2D& tex = q.glyph->texture;
+            DrawTexturePro(tex, {0, 0, (float)tex.width, (float)tex.height}, q.dst, {0, 0}, 0.0f, tint);
+        } else {
+            char tmp[2] = {q.ch, 0};
+            DrawTextEx(assets.uiFont, tmp, {q.dst.x, q.dst.y}, fontSize, spacing, tint);
+        }
+    }
+    return width;
+}
+
 static void draw_panel_tex(const Texture2D& tex, Rectangle dest, Color tint, Color fallback, bool preserveRatio = false) {
     if (tex.id != 0) {
         if (preserveRatio) {
@@ -98,15 +110,15 @@ static void draw_room(const Assets& assets, const RenderSettings& cfg, const Sce
 static void draw_symbol_box(Rectangle box, int sym, bool spinning, const TexturePack& tex);
 
 static LayoutParams gLayout{};
-static SlotLayout gSlots[casino::MAX_PLAYERS]{};
+static SlotLayout gSlots[MAX_VISIBLE_SEATS]{};
 void set_layout_params(const LayoutParams& params) { gLayout = params; }
 void set_slot_layout(int idx, const SlotLayout& slot) {
-    if (idx >= 0 && idx < casino::MAX_PLAYERS) gSlots[idx] = slot;
+    if (idx >= 0 && idx < MAX_VISIBLE_SEATS) gSlots[idx] = slot;
 }
-static Vector2 gSlotPos[casino::MAX_PLAYERS]{};
-static bool gSlotPosSet[casino::MAX_PLAYERS]{};
+static Vector2 gSlotPos[MAX_VISIBLE_SEATS]{};
+static bool gSlotPosSet[MAX_VISIBLE_SEATS]{};
 void set_slot_position(int idx, Vector2 pos) {
-    if (idx >= 0 && idx < casino::MAX_PLAYERS) {
+    if (idx >= 0 && idx < MAX_VISIBLE_SEATS) {
         gSlotPos[idx] = pos;
         gSlotPosSet[idx] = true;
     }
@@ -120,11 +132,11 @@ static int displayed_symbol(const PlayerVisual& pv, int slotIdx, int playerIdx)
 }
 
 static void draw_slots(const Assets& assets, const RenderSettings&, const CasinoSnap& snap, const SceneState& scene) {
-    for (int i = 0; i < snap.playerCount && i < casino::MAX_PLAYERS; ++i) {
+    for (int i = 0; i < snap.playerCount && i < MAX_VISIBLE_SEATS; ++i) {
         const auto& pv = scene.players[i];
         SlotLayout sl = gSlots[i].set ? gSlots[i] : SlotLayout{};
         int sid = pv.id;
-        if (sid < 0 || sid >= casino::MAX_PLAYERS) sid = i;
+        if (sid < 0 || sid >= MAX_VISIBLE_SEATS) sid = i;
         if (gSlots[sid].set) sl = gSlots[sid];
         if (!gSlots[sid].set) {
             sl.slotScale = gLayout.slotScale;
@@ -166,7 +178,7 @@ static void draw_slots(const Assets& assets, const RenderSettings&, const Casino
 }
 
 static void draw_players(const Assets& assets, const SceneState& scene) {
-    for (int i = 0; i < casino::MAX_PLAYERS; ++i) {
+    for (int i = 0; i < MAX_VISIBLE_SEATS; ++i) {
         const auto& pv = scene.players[i];
         if (!pv.active) continue;
         SlotLayout sl = gSlots[i].set ? gSlots[i] : SlotLayout{};
@@ -174,8 +186,8 @@ static void draw_players(const Assets& assets, const SceneState& scene) {
             sl.playerScale = gLayout.playerScale;
         }
         float ps = sl.playerScale;
-        int slot = (pv.id >= 0 && pv.id < casino::MAX_PLAYERS) ? pv.id : i;
-        bool winPose = (slot >= 0 && slot < casino::MAX_PLAYERS) ? scene.showWinPose[slot] : false;
+        int slot = (pv.id >= 0 && pv.id < MAX_VISIBLE_SEATS) ? pv.id : i;
+        bool winPose = (slot >= 0 && slot < MAX_VISIBLE_SEATS) ? scene.showWinPose[slot] : false;
         if (scene.gameOver || pv.spinning) winPose = false;
         const Texture2D* sheet = &assets.textures.playerIdle;
         int frameCount = 4;
@@ -292,8 +304,8 @@ static void draw_slot_panel(const Assets& assets, const RenderSettings& cfg, con
     float width = 520.0f * scale;
     float startX = 10.0f + gLayout.panelOffsetX; // décale à gauche de 10px
     float gap = 16.0f * scale; // plus d'espace entre cards
-    float startY = cfg.height - (rowH + gap) * std::min(snap.playerCount, casino::MAX_PLAYERS) - 120.0f * scale + gLayout.panelOffsetY;
-    int count = std::min(snap.playerCount, casino::MAX_PLAYERS);
+    float startY = cfg.height - (rowH + gap) * std::min(snap.playerCount, MAX_VISIBLE_SEATS) - 120.0f * scale + gLayout.panelOffsetY;
+    int count = std::min(snap.playerCount, MAX_VISIBLE_SEATS);
     std::vector<int> order;
     order.reserve(count);
     if (count == 1) {
@@ -423,9 +435,14 @@ static void draw_tableau(const Assets& assets, const RenderSettings& cfg, const
 
     // Show snapshot info
     char buf[128];
-    std::snprintf(buf, sizeof(buf), "Players: %d", snap.playerCount);
+    std::snprintf(buf, sizeof(buf), "Players: %d / %u seats", snap.playerCount, snap.capacity);
     draw_bitmap_text(assets, buf, {panel.x + 12, lineY}, 16 * scale, 1, RAYWHITE);
     lineY += lh;
+    if (snap.table_count > 1) {
+        std::snprintf(buf, sizeof(buf), "Table: %u / %u", snap.table_id, snap.table_count);
+        draw_bitmap_text(assets, buf, {panel.x + 12, lineY}, 16 * scale, 1, RAYWHITE);
+        lineY += lh;
+    }
     std::snprintf(buf, sizeof(buf), "Jackpot: %lld", static_cast<long long>(snap.jackpot));
     draw_bitmap_text(assets, buf, {panel.x + 12, lineY}, 16 * scale, 1, RAYWHITE);
     lineY += lh;
@@ -433,76 +450,133 @@ static void draw_tableau(const Assets& assets, const RenderSettings& cfg, const
     draw_bitmap_text(assets, buf, {panel.x + 12, lineY}, 16 * scale, 1, RAYWHITE);
     lineY += lh;
 
-    // Prefer server-published instrumentation for mutex state (more reliable)
-    bool mutexPresent = false;
-    bool mutexLocked = false;
-    if (att && att->valid && att->state) {
-        mutexPresent = true;
-        // Use a debounce window based on the last-held timestamp to detect recent activity.
-        uint64_t nowMs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
-        const uint64_t thresholdMs = 200; // if server held mutex within last 200ms, show as LOCKED
-        uint64_t last = snap.mutex_last_held_ts;
-        if (last != 0 && nowMs >= last && (nowMs - last) <= thresholdMs) {
-            mutexLocked = true;
-        } else {
-            mutexLocked = false;
-        }
+    // Mutex state comes from server-published instrumentation (the viewer never locks).
+    // With --lock-profile the server measures every acquisition: show hold/wait
+    // percentiles instead of guessing from the last-held timestamp.
+    if (att && att->valid && snap.lock_profile) {
+        const auto& spins = snap.lock_hold[casino::LOCK_SITE_SERVER_SPINS];
+        const auto& tick = snap.lock_hold[casino::LOCK_SITE_SERVER_TICK];
+        uint64_t waitP99 = 0;
+        for (const auto& w : snap.lock_wait) waitP99 = std::max(waitP99, w.p99Ns);
+        std::snprintf(buf, sizeof(buf), "Mutex hold us p50/p99: spins %.1f/%.1f tick %.1f/%.1f",
+                      spins.p50Ns / 1000.0, spins.p99Ns / 1000.0, tick.p50Ns / 1000.0, tick.p99Ns / 1000.0);
+        draw_bitmap_text(assets, buf, {panel.x + 12, lineY}, 14 * scale, 1, Color{200,220,255,255});
+        lineY += lh;
+        std::snprintf(buf, sizeof(buf), "Mutex wait us p99 (worst site): %.1f", waitP99 / 1000.0);
+        draw_bitmap_text(assets, buf, {panel.x + 12, lineY}, 14 * scale, 1, waitP99 > 1000000 ? Color{255,120,120,255} : Color{120,255,140,255});
+        lineY += lh;
     } else {
-        // Fallback: attempt trylock if we have access
-        if (att && att->state) {
-            int r = pthread_mutex_trylock(&att->state->mutex);
-            if (r == 0) {
-                pthread_mutex_unlock(&att->state->mutex);
-                mutexPresent = true;
-                mutexLocked = false;
-            } else if (r == EBUSY) {
-                mutexPresent = true;
+        bool mutexPresent = false;
+        bool mutexLocked = false;
+        if (att && att->valid && att->state) {
+            mutexPresent = true;
+            // Use a debounce window based on the last-held timestamp to detect recent activity.
+            uint64_t nowMs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+            const uint64_t thresholdMs = 200; // if server held mutex within last 200ms, show as LOCKED
+            uint64_t last = snap.mutex_last_held_ts;
+            if (last != 0 && nowMs >= last && (nowMs - last) <= thresholdMs) {
                 mutexLocked = true;
+            } else {
+                mutexLocked = false;
             }
         }
+        if (mutexPresent) {
+            draw_bitmap_text(assets, std::string("Mutex: ") + (mutexLocked ? "LOCKED" : "UNLOCKED"), {panel.x + 12, lineY}, 16 * scale, 1, mutexLocked ? Color{255,120,120,255} : Color{120,255,140,255});
+        } else {
+            draw_bitmap_text(assets, "Mutex: unavailable", {panel.x + 12, lineY}, 16 * scale, 1, Color{200,200,200,255});
+        }
+        lineY += lh;
     }
-    if (mutexPresent) {
-        draw_bitmap_text(assets, std::string("Mutex: ") + (mutexLocked ? "LOCKED" : "UNLOCKED"), {panel.x + 12, lineY}, 16 * scale, 1, mutexLocked ? Color{255,120,120,255} : Color{120,255,140,255});
+
+    // Seqlock reader cost: the viewer copies snapshots without ever taking the mutex
+    if (att && att->valid) {
+        std::snprintf(buf, sizeof(buf), "Seqlock: %llu reads / %llu retries / %llu slow",
+                      static_cast<unsigned long long>(att->reads), static_cast<unsigned long long>(att->retries),
+                      static_cast<unsigned long long>(att->slowReads));
+        draw_bitmap_text(assets, buf, {panel.x + 12, lineY}, 14 * scale, 1, att->slowReads ? Color{255,200,120,255} : Color{200,220,255,255});
+        lineY += lh;
+        // change tracking: frames with nothing new skip the copy, the others copy changed seats only
+        std::snprintf(buf, sizeof(buf), "Copy: %llu unchanged / %llu seats copied (gen %u)",
+                      static_cast<unsigned long long>(att->unchangedReads),
+                      static_cast<unsigned long long>(att->seatsCopied), snap.generation);
+        draw_bitmap_text(assets, buf, {panel.x + 12, lineY}, 14 * scale, 1, Color{200,220,255,255});
+        lineY += lh;
+    }
+
+    // Server wakeups: futex wakes producers paid because the event loop was parked
+    if (att && att->valid && snap.bet_transport == casino::BET_TRANSPORT_RING) {
+        std::snprintf(buf, sizeof(buf), "Wakeups(futex): %llu", static_cast<unsigned long long>(snap.bet_wakeups));
+        draw_bitmap_text(assets, buf, {panel.x + 12, lineY}, 14 * scale, 1, Color{200,220,255,255});
     } else {
-        draw_bitmap_text(assets, "Mutex: unavailable", {panel.x + 12, lineY}, 16 * scale, 1, Color{200,200,200,255});
+        draw_bitmap_text(assets, std::string("Wakeups: mq (epoll)"), {panel.x + 12, lineY}, 14 * scale, 1, Color{160,160,160,255});
     }
     lineY += lh;
 
-    // Semaphore: try open and read value
-    bool semOk = false;
-    int semVal = 0;
-    sem_t* sem = sem_open(casino::SEM_NAME, 0);
-    if (sem != SEM_FAILED) {
-        semOk = true;
-        sem_getvalue(sem, &semVal);
-        sem_close(sem);
-    }
-    if (semOk) {
-        std::snprintf(buf, sizeof(buf), "Semaphore(%s): %d", casino::SEM_NAME, semVal);
-        draw_bitmap_text(assets, buf, {panel.x + 12, lineY}, 14 * scale, 1, Color{200,220,255,255});
+    // Bet channel: depth and overflows published by the server (ring, or MQ fallback)
+    if (att && att->valid) {
+        bool ring = snap.bet_transport == casino::BET_TRANSPORT_RING;
+        std::snprintf(buf, sizeof(buf), "Bets(%s): %d pending / %llu overflow / %llu lost", ring ? "ring" : "mq", snap.bet_depth,
+                      static_cast<unsigned long long>(snap.bet_overflows), static_cast<unsigned long long>(snap.bet_abandoned));
+        const bool lossy = snap.bet_overflows || snap.bet_abandoned;
+        draw_bitmap_text(assets, buf, {panel.x + 12, lineY}, 14 * scale, 1, lossy ? Color{255,200,120,255} : Color{200,220,255,255});
     } else {
-        draw_bitmap_text(assets, std::string("Semaphore: unavailable"), {panel.x + 12, lineY}, 14 * scale, 1, Color{160,160,160,255});
+        draw_bitmap_text(assets, std::string("Bets: unavailable"), {panel.x + 12, lineY}, 14 * scale, 1, Color{160,160,160,255});
     }
     lineY += lh;
 
-    // Message queue presence
-    bool mqOk = false;
-    long mqMsgs = -1;
-    mqd_t mq = mq_open(casino::MQ_NAME, O_RDONLY | O_NONBLOCK);
-    if (mq != static_cast<mqd_t>(-1)) {
-        mqOk = true;
-        struct mq_attr attr{};
-        mq_getattr(mq, &attr);
-        mqMsgs = attr.mq_curmsgs;
-        mq_close(mq);
+    // Bet frames: sequence faults should stay at zero
+    if (att && att->valid && snap.bet_frames > 0) {
+        const bool faults = snap.bet_seq_gaps || snap.bet_seq_dups || snap.bet_bad_frames;
+        std::snprintf(buf, sizeof(buf), "Frames: %llu / %llu gaps / %llu dups / %llu bad",
+                      static_cast<unsigned long long>(snap.bet_frames), static_cast<unsigned long long>(snap.bet_seq_gaps),
+                      static_cast<unsigned long long>(snap.bet_seq_dups), static_cast<unsigned long long>(snap.bet_bad_frames));
+        draw_bitmap_text(assets, buf, {panel.x + 12, lineY}, 14 * scale, 1, faults ? Color{255,200,120,255} : Color{200,220,255,255});
+        lineY += lh;
     }
-    if (mqOk) {
-        std::snprintf(buf, sizeof(buf), "MessageQueue(%s): %ld msgs", casino::MQ_NAME, mqMsgs);
+
+    // Cooldown slots: bets held until their seat could spin, coalesced, or expired
+    if (att && att->valid && (snap.bet_deferred || snap.bet_coalesced)) {
+        std::snprintf(buf, sizeof(buf), "Held: %llu / %llu coalesced / %llu expired",
+                      static_cast<unsigned long long>(snap.bet_deferred), static_cast<unsigned long long>(snap.bet_coalesced),
+                      static_cast<unsigned long long>(snap.bet_expired));
+        draw_bitmap_text(assets, buf, {panel.x + 12, lineY}, 14 * scale, 1, snap.bet_expired ? Color{255,200,120,255} : Color{200,220,255,255});
+        lineY += lh;
+    }
+
+    // Batch commits: spins applied per critical section (rounds counts every spin)
+    if (att && att->valid && snap.batch_commits > 0) {
+        double avg = static_cast<double>(snap.rounds) / static_cast<double>(snap.batch_commits);
+        std::snprintf(buf, sizeof(buf), "Batches: %llu commits / avg %.2f / max %u",
+                      static_cast<unsigned long long>(snap.batch_commits), avg, snap.batch_max);
         draw_bitmap_text(assets, buf, {panel.x + 12, lineY}, 14 * scale, 1, Color{200,220,255,255});
-    } else {
-        draw_bitmap_text(assets, std::string("MessageQueue: unavailable"), {panel.x + 12, lineY}, 14 * scale, 1, Color{160,160,160,255});
+        lineY += lh;
+    }
+
+    // Spin events consumed through this viewer's cursor (lost: lapped by the server)
+    if (att && att->valid) {
+        std::snprintf(buf, sizeof(buf), "Events: %llu read / %llu lost", static_cast<unsigned long long>(snap.events_read),
+                      static_cast<unsigned long long>(snap.events_lost));
+        draw_bitmap_text(assets, buf, {panel.x + 12, lineY}, 14 * scale, 1, snap.events_lost ? Color{255,200,120,255} : Color{200,220,255,255});
+        lineY += lh;
+    }
+
+    // Bet latency (send -> result published), and bets the server dropped
+    if (att && att->valid) {
+        const auto& total = snap.latency[casino::latency_index(casino::LAT_TOTAL, casino::BET_ACCEPTED)];
+        const auto& queue = snap.latency[casino::latency_index(casino::LAT_QUEUE, casino::BET_ACCEPTED)];
+        std::snprintf(buf, sizeof(buf), "Latency us p50/p99/p999: %.0f / %.0f / %.0f (queue p99 %.0f)",
+                      total.p50Ns / 1000.0, total.p99Ns / 1000.0, total.p999Ns / 1000.0, queue.p99Ns / 1000.0);
+        draw_bitmap_text(assets, buf, {panel.x + 12, lineY}, 14 * scale, 1, Color{200,220,255,255});
+        lineY += lh;
+        uint64_t cooldown = snap.latency[casino::latency_index(casino::LAT_TOTAL, casino::BET_COOLDOWN)].count;
+        uint64_t invalid = snap.latency[casino::latency_index(casino::LAT_TOTAL, casino::BET_INVALID)].count;
+        std::snprintf(buf, sizeof(buf), "Bets: %llu accepted / %llu cooldown / %llu invalid",
+                      static_cast<unsigned long long>(total.count), static_cast<unsigned long long>(cooldown),
+                      static_cast<unsigned long long>(invalid));
+        draw_bitmap_text(assets, buf, {panel.x + 12, lineY}, 14 * scale, 1, invalid ? Color{255,200,120,255} : Color{200,220,255,255});
+        lineY += lh;
     }
-    lineY += lh + 6;
+    lineY += 6;
 
     // Per-player detailed rows
     draw_bitmap_text(assets, "Players (id : lastDelta / spinning)", {panel.x + 12, lineY}, 14 * scale, 1, Color{220,220,220,255});